@@ -6,16 +6,48 @@
  *      Author: Andrew Melim <Andrew.Melim@gatech.edu>
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <unistd.h>
 #include <string>
 #include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <boost/scoped_ptr.hpp>
 
 // Serial reading for GPS/IMU
 #include "serial/ASIOSerialPort.h"
 
+// IMU parsing and per-frame IMU blocks
+#include "imu/ImuSample.h"
+#include "imu/ImuFrameAligner.h"
+#include "imu/AttitudeEstimator.h"
+
+// FAST corners and decimated images on a worker thread
+#include "vision/FeatureWorker.h"
+#include "vision/FrameChange.h"
+
+// GPS parsing and the telemetry radio
+#include "gps/NmeaParser.h"
+#include "gps/GpsClock.h"
+#include "telemetry/TelemetryDownlink.h"
+
+// Block buffered text log and its time index
+#include "log/LogWriter.h"
+#include "log/LogIndex.h"
+#include "log/ChecksumManifest.h"
+#include "util/Crc32c.h"
+
+// Thread scheduling and IMU jitter measurement
+#include "util/RealTime.h"
+#include "util/JitterMeter.h"
+
+#ifdef BBLOG_ALLOC_CHECK
+#include "util/AllocCounter.h"
+#endif
+
 // FlyCapture for Point Grey camera
 #include "FlyCapture2.h"
 
@@ -24,6 +56,27 @@ using namespace FlyCapture2;
 // Forward declare diff function
 timespec diff(timespec start, timespec end);
 
+// What is written for every captured frame
+enum ImageMode { IMAGES_FULL, IMAGES_HALF, IMAGES_NONE };
+
+/* ************************************************************************* */
+void PrintUsage(){
+  std::cout << "Usage: bblog /file/to/logdir [options]" << std::endl
+            << "  --features          write FAST-9 corners of every frame to Image-*.fast" << std::endl
+            << "  --fast-threshold=N  FAST intensity threshold (default 20)" << std::endl
+            << "  --images=MODE       full (default), half (2x2 decimated) or none" << std::endl
+            << "  --telemetry=DEVICE  send live telemetry over a serial radio" << std::endl
+            << "  --telemetry-baud=N  radio baud rate (default 57600)" << std::endl
+            << "  --telemetry-rate=N  radio budget in bytes per second (default 500)" << std::endl
+            << "  --rt-capture=P[@C]  SCHED_FIFO priority P (and CPU C) for the capture loop" << std::endl
+            << "  --rt-serial=P[@C]   same for the IMU, GPS and radio serial threads" << std::endl
+            << "  --rt-writer=P[@C]   same for the frame worker, log writer and checksum threads" << std::endl
+            << "  --mlock             lock all memory in RAM once set up" << std::endl
+            << "  --jitter=HZ         log IMU inter-arrival deviation against HZ" << std::endl
+            << "  --skip-still=T      skip frames changing less than T gray levels (eg. 2)" << std::endl
+            << "  --skip-keep-every=N keep at least every Nth frame when skipping (default 10)" << std::endl;
+}
+
 /* ************************************************************************* */
 void PrintError(Error error){
   error.PrintErrorTrace();
@@ -97,36 +150,381 @@ bool PollForTriggerReady(Camera* pCam){
   return true;
 }
 
+/* ************************************************************************* */
+// Appends the IMU block of every frame to a binary file next to the log
+class FrameBlockLogger{
+public:
+  FrameBlockLogger(ofstream& out, size_t maxSamples, ChecksumManifest* checksums)
+    : Lwrite(this), _out(out), _buffer(maxEncodedImuFrameBlockSize(maxSamples)),
+      _checksums(checksums), _offset(0) {}
+
+  void write(const ImuFrameBlock& block){
+    size_t length = encodeImuFrameBlock(block, &_buffer[0], _buffer.size());
+    if(length > 0){
+      _out.write(&_buffer[0], length);
+      _checksums->addRange("frame_imu.bin", _offset, length, crc32c(0, &_buffer[0], length));
+      _offset += length;
+    }
+  }
+
+  LISTENER(FrameBlockLogger, write, const ImuFrameBlock&);
+
+private:
+  ofstream& _out;
+  std::vector<char> _buffer;
+  ChecksumManifest* _checksums;
+  unsigned long long _offset;
+};
+
+/* ************************************************************************* */
+// Records drop-outs of a serial port in the log. The events fire on
+// whichever thread noticed the drop-out, which is fine as LogWriter takes
+// its own lock.
+class PortStateLogger{
+public:
+  PortStateLogger(LogWriter& log)
+    : LdisconnectEvent(this), LreconnectEvent(this), _log(log) {}
+
+  void disconnectEvent(const SerialConnectionChange& change){
+    char text[256];
+    int length = snprintf(text, sizeof(text), "%s down %s", change.port, change.reason);
+    record(text, length);
+  }
+
+  void reconnectEvent(const SerialConnectionChange& change){
+    char text[256];
+    int length = snprintf(text, sizeof(text), "%s up %.3f %u", change.port, change.downSeconds, change.attempts);
+    record(text, length);
+  }
+
+  LISTENER(PortStateLogger, disconnectEvent, const SerialConnectionChange&);
+  LISTENER(PortStateLogger, reconnectEvent, const SerialConnectionChange&);
+
+private:
+  void record(const char* text, int length){
+    if(length <= 0)
+      return;
+    timespec stamp;
+    clock_gettime(CLOCK_MONOTONIC, &stamp);
+    _log.write("ser", stamp, text, std::min(length, 255));
+  }
+
+  LogWriter& _log;
+};
+
+/* ************************************************************************* */
+// Logs GPS lines on the event thread of their port, stamped as they arrive.
+// RMC times discipline the UTC clock model; a "clk" record follows each one
+// with the residual (ms), drift (ppm), residual RMS (ms) and whether it was
+// accepted. The latest fix is handed over to the capture loop.
+class GpsLineLogger{
+public:
+  GpsLineLogger(LogWriter& log, GpsClock& clock)
+    : LhandleLine(this), _log(log), _clock(clock), _fix(emptyGpsFix()), _fresh(false), _locked(false) {}
+
+  void handleLine(const SerialLine& line){
+    // The "\r\n" of a sentence also ends an empty line
+    if(line.length == 0)
+      return;
+    long long local = line.stamp;
+    timespec arrival;
+    arrival.tv_sec = local / 1000000000LL;
+    arrival.tv_nsec = local % 1000000000LL;
+    boost::mutex::scoped_lock lock(_lock);
+    unsigned char updated = parseNmeaLine(line.data, line.length, _fix);
+    long long gpsUtc;
+    bool timed = (updated & GPS_HAS_TIME) && (updated & GPS_HAS_DATE) && gpsFixUtc(_fix, gpsUtc);
+    bool accepted = timed && _clock.add(gpsUtc, local);
+    _log.write("gps", arrival, _clock.toUtc(local), line.data, line.length);
+    if(timed){
+      GpsClockState state = _clock.state();
+      float values[4] = { (float)(state.lastResidual * 1e3), (float)(state.drift * 1e6),
+                          (float)(state.residualRms * 1e3), accepted ? 1.0f : 0.0f };
+      _log.writeValues("clk", arrival, values, 4);
+      if(state.valid && !_locked)
+        std::cout << "GPS clock locked, drift " << state.drift * 1e6 << " ppm" << std::endl;
+      _locked = state.valid;
+    }
+    if(updated){
+      _fix.stamp = local;
+      _fresh = true;
+    }
+  }
+
+  // Copies the fix if it changed since the last call
+  bool takeFix(GpsFix& fix){
+    boost::mutex::scoped_lock lock(_lock);
+    if(!_fresh)
+      return false;
+    fix = _fix;
+    _fresh = false;
+    return true;
+  }
+
+  LISTENER(GpsLineLogger, handleLine, const SerialLine&);
+
+private:
+  LogWriter& _log;
+  GpsClock& _clock;
+  boost::mutex _lock;
+  GpsFix _fix;
+  bool _fresh;
+  bool _locked;
+};
+
+/* ************************************************************************* */
+// Handles IMU lines on the event thread of their port, stamped as they
+// arrive, so a slow frame in the capture loop neither delays nor bunches
+// the samples: jitter, the "imu" record, frame alignment and the attitude
+// estimate. The capture loop reaches the aligner and the estimator through
+// addFrame(), frameAttitude() and takeAttitude().
+class ImuLineLogger{
+public:
+  ImuLineLogger(LogWriter& log, GpsClock& clock, ImuFrameAligner& aligner, AttitudeEstimator& estimator,
+                JitterMeter* jitter)
+    : LhandleLine(this), _log(log), _clock(clock), _aligner(aligner), _estimator(estimator),
+      _jitter(jitter), _attitudeStamp(0), _fresh(false)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &_jitterReported);
+  }
+
+  void handleLine(const SerialLine& line){
+    const time_t k_jitterReportSeconds = 10;
+    // The "\r\n" of a record also ends an empty line
+    if(line.length == 0)
+      return;
+    timespec arrival;
+    arrival.tv_sec = line.stamp / 1000000000LL;
+    arrival.tv_nsec = line.stamp % 1000000000LL;
+    if(_jitter){
+      float deviationMs = _jitter->add(line.stamp) * 1e3;
+      _log.writeValues("jit", arrival, &deviationMs, 1);
+      if(arrival.tv_sec - _jitterReported.tv_sec >= k_jitterReportSeconds){
+        _jitter->writeReport(std::cout);
+        _jitterReported = arrival;
+      }
+    }
+    std::cout.write(line.data, line.length);
+    std::cout << std::endl;
+    // Only lines with a single leading '!' are IMU records
+    if(line.data[0] != '!' || memchr(line.data + 1, '!', line.length - 1))
+      return;
+    _log.write("imu", arrival, _clock.toUtc(line.stamp), line.data, line.length);
+    ImuSample sample;
+    if(!parseImuLine(line.data, line.length, sample))
+      return;
+    sample.stamp = line.stamp;
+    boost::mutex::scoped_lock lock(_lock);
+    _aligner.addSample(sample);
+    _estimator.update(sample);
+    if(_estimator.initialized()){
+      _estimator.eulerAngles(_rpy[0], _rpy[1], _rpy[2]);
+      _attitudeStamp = sample.stamp;
+      _fresh = true;
+    }
+  }
+
+  // Closes the IMU block of a frame captured at stamp
+  void addFrame(long long stamp){
+    boost::mutex::scoped_lock lock(_lock);
+    _aligner.addFrame(stamp);
+  }
+
+  // Attitude and what was preintegrated since the last frame; starts the next interval
+  bool frameAttitude(float* rpy, float* preint){
+    boost::mutex::scoped_lock lock(_lock);
+    if(!_estimator.initialized())
+      return false;
+    _estimator.eulerAngles(rpy[0], rpy[1], rpy[2]);
+    flattenPreintegration(_estimator.preintegration(), preint);
+    _estimator.resetPreintegration();
+    return true;
+  }
+
+  // Copies the latest attitude if it changed since the last call
+  bool takeAttitude(long long& stamp, float* rpy){
+    boost::mutex::scoped_lock lock(_lock);
+    if(!_fresh)
+      return false;
+    stamp = _attitudeStamp;
+    rpy[0] = _rpy[0];
+    rpy[1] = _rpy[1];
+    rpy[2] = _rpy[2];
+    _fresh = false;
+    return true;
+  }
+
+  LISTENER(ImuLineLogger, handleLine, const SerialLine&);
+
+private:
+  LogWriter& _log;
+  GpsClock& _clock;
+  ImuFrameAligner& _aligner;
+  AttitudeEstimator& _estimator;
+  JitterMeter* _jitter;
+  timespec _jitterReported;
+  boost::mutex _lock;
+  float _rpy[3];
+  long long _attitudeStamp;
+  bool _fresh;
+};
+
 /* ************************************************************************* */
 int main(int argc, char *argv[]){
 
   if(argc < 2){
-    std::cout << "Usage: bblog /file/to/logdir" << std::endl;
+    PrintUsage();
     return -1;
   }
-    
-  string nextLine, gpsLine;
+
+  bool writeFeatures = false;
+  int fastThreshold = 20;
+  ImageMode imageMode = IMAGES_FULL;
+  std::string telemetryDevice;
+  size_t telemetryBaud = 57600;
+  size_t telemetryRate = 500;
+  ThreadPolicy capturePolicy, serialPolicy, writerPolicy;
+  bool lockMemory = false;
+  double imuRate = 0;
+  float skipThreshold = 0;
+  int skipKeepEvery = 10;
+  for(int i = 2; i < argc; i++){
+    if(strcmp(argv[i], "--features") == 0)
+      writeFeatures = true;
+    else if(strncmp(argv[i], "--fast-threshold=", 17) == 0)
+      fastThreshold = atoi(argv[i] + 17);
+    else if(strcmp(argv[i], "--images=full") == 0)
+      imageMode = IMAGES_FULL;
+    else if(strcmp(argv[i], "--images=half") == 0)
+      imageMode = IMAGES_HALF;
+    else if(strcmp(argv[i], "--images=none") == 0)
+      imageMode = IMAGES_NONE;
+    else if(strncmp(argv[i], "--telemetry=", 12) == 0)
+      telemetryDevice = argv[i] + 12;
+    else if(strncmp(argv[i], "--telemetry-baud=", 17) == 0)
+      telemetryBaud = atoi(argv[i] + 17);
+    else if(strncmp(argv[i], "--telemetry-rate=", 17) == 0)
+      telemetryRate = atoi(argv[i] + 17);
+    else if(strncmp(argv[i], "--rt-capture=", 13) == 0 && parseThreadPolicy(argv[i] + 13, capturePolicy))
+      ;
+    else if(strncmp(argv[i], "--rt-serial=", 12) == 0 && parseThreadPolicy(argv[i] + 12, serialPolicy))
+      ;
+    else if(strncmp(argv[i], "--rt-writer=", 12) == 0 && parseThreadPolicy(argv[i] + 12, writerPolicy))
+      ;
+    else if(strcmp(argv[i], "--mlock") == 0)
+      lockMemory = true;
+    else if(strncmp(argv[i], "--jitter=", 9) == 0 && (imuRate = atof(argv[i] + 9)) > 0)
+      ;
+    else if(strncmp(argv[i], "--skip-still=", 13) == 0 && (skipThreshold = atof(argv[i] + 13)) > 0)
+      ;
+    else if(strncmp(argv[i], "--skip-keep-every=", 18) == 0 && (skipKeepEvery = atoi(argv[i] + 18)) > 0)
+      ;
+    else{
+      PrintUsage();
+      return -1;
+    }
+  }
+
   time_t timer;
   clock_t clockt;
-  // time_serial : High rate sensors
-  // time_c* : Camera trigger timer
-  timespec time_serial, time_c1, time_c2, difft;
+  // time_c* : Camera trigger timer, on the monotonic clock like every record
+  timespec time_c1, time_c2, difft;
   std::cout << "Beginning logging: " << std::endl << std::endl;
 
-  ofstream logFile;
+  LogWriter logFile;
   std::string logDir(argv[1]);
   std::string logName("log.txt");
   std::string logPath = logDir + logName;
 
-  logFile.open(logPath.c_str());
+  if(!logFile.open(logPath.c_str()))
+    std::cout << "Could not open " << logPath << std::endl;
+
+  // Sparse time index for logWindow: log.txt offsets and captured frames
+  TimeIndexWriter logIndex, frameIndex;
+  logIndex.open((logDir + "log.idx").c_str(), kLogIndexMagic);
+  frameIndex.open((logDir + "frames.idx").c_str(), kFrameIndexMagic);
+  logFile.setIndex(&logIndex);
+
+  // CRC-32C of every log block and every file written, for logVerify
+  ChecksumManifest checksums;
+  checksums.open((logDir + "checksums.txt").c_str());
+  logFile.setChecksums(&checksums, "log.txt");
+  if(!writerPolicy.isDefault()){
+    logFile.setThreadPolicy(writerPolicy);
+    checksums.setThreadPolicy(writerPolicy);
+  }
+  std::cout << "Checksums with " << crc32cKernel() << " CRC-32C" << std::endl;
   std::cout << "Opening: " << argv[1] << std::endl;
 
+  // IMU samples between consecutive frames, interpolated to each frame
+  const size_t k_imuRingSize = 512;
+  ofstream frameImuFile;
+  std::string frameImuPath = logDir + "frame_imu.bin";
+  frameImuFile.open(frameImuPath.c_str(), ios::out | ios::binary);
+  ImuFrameAligner aligner(k_imuRingSize);
+  FrameBlockLogger frameBlockLogger(frameImuFile, k_imuRingSize, &checksums);
+  aligner.onFrameBlock += &frameBlockLogger.Lwrite;
+
+  // On-board attitude at the full IMU rate, integrated at the nominal rate
+  // so samples bunched by a stall are not dropped as a gap
+  const double k_defaultImuRate = 50;
+  AttitudeEstimator estimator;
+  estimator.setNominalRate(imuRate > 0 ? imuRate : k_defaultImuRate);
+
+  boost::scoped_ptr<FeatureWorker> featureWorker;
+  if(writeFeatures || imageMode == IMAGES_HALF){
+    featureWorker.reset(new FeatureWorker(logDir, writeFeatures, imageMode == IMAGES_HALF, fastThreshold));
+    std::cout << "Frame worker using " << FastDetector::simdKernel() << " FAST kernel" << std::endl;
+    if(!writerPolicy.isDefault())
+      featureWorker->setThreadPolicy(writerPolicy);
+    featureWorker->setChecksums(&checksums);
+  }
+
+  // Drops frames that barely differ from the last one written
+  boost::scoped_ptr<FrameChangeFilter> frameFilter;
+  if(skipThreshold > 0){
+    frameFilter.reset(new FrameChangeFilter(skipThreshold, skipKeepEvery));
+    std::cout << "Skipping still frames below " << skipThreshold << " gray levels, keeping every "
+              << skipKeepEvery << "th at least" << std::endl;
+  }
+
+  unsigned long long framesCaptured = 0;
+  boost::scoped_ptr<ASIOSerialPort> radio;
+  boost::scoped_ptr<TelemetryDownlink> downlink;
+  if(!telemetryDevice.empty()){
+    radio.reset(new ASIOSerialPort(telemetryDevice, telemetryBaud));
+    radio->setThreadPolicy(serialPolicy);
+    downlink.reset(new TelemetryDownlink(*radio, telemetryRate));
+    std::cout << "Telemetry on " << telemetryDevice << " at " << telemetryRate << " bytes/s" << std::endl;
+  }
+
   std::cout << "sleeping..." << std::endl;
   sleep(10);
   std::cout << "resuming" << std::endl;
 
   ASIOSerialPort imu("/dev/ttyO2", 57600);
   ASIOSerialPort gps("/dev/ttyO1", 38400);
+  // Both ports are read on their event threads under --rt-serial and
+  // reopen themselves if they drop out
+  imu.setThreadPolicy(serialPolicy);
+  gps.setThreadPolicy(serialPolicy);
+  PortStateLogger imuState(logFile);
+  imu.onDisconnect += &imuState.LdisconnectEvent;
+  imu.onReconnect += &imuState.LreconnectEvent;
+
+  // GPS time of arrival gives every record a UTC stamp once locked
+  GpsClock gpsClock;
+  GpsLineLogger gpsLines(logFile, gpsClock);
+  gps.onLineData += &gpsLines.LhandleLine;
+  gps.startEvents();
+
+  // Inter-arrival deviation of IMU lines
+  boost::scoped_ptr<JitterMeter> imuJitter;
+  if(imuRate > 0)
+    imuJitter.reset(new JitterMeter(imuRate));
+  ImuLineLogger imuLines(logFile, gpsClock, aligner, estimator, imuJitter.get());
+  imu.onLineData += &imuLines.LhandleLine;
+  imu.startEvents();
 
   //PGFlyCap Objects
   Error error;
@@ -176,41 +574,43 @@ int main(int argc, char *argv[]){
     return -1;
   }
 
-  Image rawImage;
+  Image rawImage, monoImage;
+
+  // Everything big is allocated by now, so lock it in and go real-time
+  if(lockMemory && lockProcessMemory())
+    std::cout << "Memory locked" << std::endl;
+  if(!capturePolicy.isDefault())
+    applyThreadPolicy(capturePolicy, "capture");
+
   // Get init camera clock
-  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time_c1);
+  clock_gettime(CLOCK_MONOTONIC, &time_c1);
   long int fr = 1; // seconds
+
+  // IMU lines are handled on the event thread of their port; this loop
+  // only paces the camera and the radio
+  const int k_loopSleepUs = 5000;
+#ifdef BBLOG_ALLOC_CHECK
+  // Everything has been sized by then; FlyCapture itself is not ours to fix
+  const unsigned long long k_allocWarmupFrames = 10;
+#endif
   while(1)
   {
-    try{
-      nextLine = imu.readln();
-    }
-    catch(...){
-      continue;
-    }
-    if (nextLine != ""){
-      std::cout << nextLine << std::endl;
-      clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time_serial);
-      if(nextLine.find_last_of('!') == 0)
-        logFile << "imu " << time_serial.tv_sec << " " << time_serial.tv_nsec << " " <<  nextLine << std::endl;
+    usleep(k_loopSleepUs);
+    clock_gettime(CLOCK_MONOTONIC, &time_c2);
+    if(downlink){
+      long long attitudeStamp;
+      float rpy[3];
+      if(imuLines.takeAttitude(attitudeStamp, rpy))
+        downlink->update(attitudeTelemetry(attitudeStamp, rpy[0], rpy[1], rpy[2]));
+      // The budget is in bytes per wall-clock second
+      downlink->poll(toNanoseconds(time_c2));
     }
-
-
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time_c2);
     difft = diff(time_c1, time_c2);
     if((long int)difft.tv_sec >= fr){
 
-      try{
-        //gpsLine = gps.readln();
-      }
-      catch(...){
-        std::cout << "gps read fail" << std::endl;
-      }
-      if(gpsLine != ""){
-        std::cout << gpsLine << std::endl;
-        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time_serial);
-        logFile << "gps " << time_serial.tv_sec << " " << time_serial.tv_nsec << " " <<  gpsLine << std::endl;
-      }
+      GpsFix gpsFix;
+      if(downlink && gpsLines.takeFix(gpsFix))
+        downlink->update(gpsTelemetry(gpsFix));
 
       //retVal = FireSoftwareTrigger(&cam);
       time_c1 = time_c2;
@@ -220,16 +620,81 @@ int main(int argc, char *argv[]){
         continue;
       }
 
-      char filename[512];
-      clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time_c1);
-      sprintf(filename, "Image-%lld-%.9ld.pgm", (long long)time_c2.tv_sec, time_c2.tv_nsec);
-      string imgName(filename);
-      string imgPath = logDir + imgName;
-      error = rawImage.Save(imgPath.c_str());
-      if(error != PGRERROR_OK){
-        PrintError(error);
-        continue;
+      char baseName[64];
+      char imgName[80];
+      char imgPath[512];
+      clock_gettime(CLOCK_MONOTONIC, &time_c1);
+      timespec time_frame;
+      clock_gettime(CLOCK_MONOTONIC, &time_frame);
+      long long frameUtc = gpsClock.toUtc(toNanoseconds(time_frame));
+      frameBaseName(toNanoseconds(time_frame), baseName, sizeof(baseName));
+
+      Image* grayImage = &rawImage;
+      bool haveGray = true;
+      if((featureWorker || frameFilter) && rawImage.GetPixelFormat() != PIXEL_FORMAT_MONO8){
+        error = rawImage.Convert(PIXEL_FORMAT_MONO8, &monoImage);
+        if(error != PGRERROR_OK){
+          PrintError(error);
+          haveGray = false;
+        }
+        grayImage = &monoImage;
       }
+
+      // Still frames are not written at all; every decision goes to the log
+      bool keepFrame = true;
+      if(frameFilter && haveGray){
+        FrameChangeFilter::Decision decision =
+            frameFilter->check(grayImage->GetData(), grayImage->GetCols(), grayImage->GetRows(),
+                               grayImage->GetStride());
+        keepFrame = decision.keep;
+        char text[96];
+        int length = snprintf(text, sizeof(text), "%s %d %.3f %s", baseName, decision.keep ? 1 : 0,
+                              decision.change, FrameChangeFilter::reasonName(decision.reason));
+        logFile.write("fsk", time_frame, frameUtc, text, length);
+      }
+
+      if(keepFrame && imageMode == IMAGES_FULL){
+        snprintf(imgName, sizeof(imgName), "%s.pgm", baseName);
+        snprintf(imgPath, sizeof(imgPath), "%s%s", logDir.c_str(), imgName);
+        error = rawImage.Save(imgPath);
+        if(error != PGRERROR_OK){
+          PrintError(error);
+          continue;
+        }
+        checksums.queueFile(imgPath, imgName);
+      }
+      if(keepFrame && featureWorker && haveGray){
+        if(!featureWorker->submit(grayImage->GetData(), grayImage->GetCols(), grayImage->GetRows(),
+                                  grayImage->GetStride(), baseName))
+          std::cout << "frame worker busy, dropped " << baseName << std::endl;
+      }
+      if(keepFrame){
+        // "cam", not "frm": logWindow prints the frame files as frm lines
+        logFile.write("cam", time_frame, frameUtc, baseName, strlen(baseName));
+        imuLines.addFrame(toNanoseconds(time_frame));
+        frameIndex.add(toNanoseconds(time_frame), logFile.size());
+      }
+      framesCaptured++;
+      if(downlink){
+        downlink->update(cameraTelemetry(toNanoseconds(time_frame), framesCaptured,
+                                         featureWorker ? featureWorker->dropped() : 0,
+                                         featureWorker ? featureWorker->lastKeypointCount() : 0));
+      }
+
+      // What the IMU saw since the previous frame, for the visual odometry
+      float rpy[3], preint[kPreintegrationValues];
+      if(imuLines.frameAttitude(rpy, preint)){
+        logFile.writeValues("att", time_frame, rpy, 3);
+        logFile.writeValues("pre", time_frame, preint, kPreintegrationValues);
+      }
+
+#ifdef BBLOG_ALLOC_CHECK
+      if(framesCaptured == k_allocWarmupFrames)
+        AllocCounter::arm();
+      else if(framesCaptured > k_allocWarmupFrames && framesCaptured % 100 == 0)
+        std::cout << "allocations since frame " << k_allocWarmupFrames << ": "
+                  << AllocCounter::count() << " (" << AllocCounter::bytes() << " bytes)" << std::endl;
+#endif
     }
   }
   return 0;
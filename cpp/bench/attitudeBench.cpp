@@ -0,0 +1,61 @@
+/*
+ * attitudeBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Measures the cost per IMU sample of the on-board attitude estimator.
+ * Run it on the BeagleBone to get numbers for the ARM target.
+ */
+
+#include <iostream>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#include "imu/AttitudeEstimator.h"
+
+int main(int argc, char *argv[]){
+  int numSamples = 1000000;
+  if(argc > 1)
+    numSamples = atoi(argv[1]);
+#ifndef __OPTIMIZE__
+  std::cout << "Built without optimisation, these numbers are not the target's" << std::endl;
+#endif
+
+  // Synthetic 50Hz stream of a slow coning motion, precomputed so only the
+  // estimator is timed
+  const int k_period = 1024;
+  std::vector<ImuSample> samples(k_period);
+  for(int i = 0; i < k_period; i++){
+    ImuSample& s = samples[i];
+    float t = i * 0.02f;
+    s.fields = IMU_HAS_EULER | IMU_HAS_GYRO | IMU_HAS_ACCEL;
+    s.gyro[0] = 20.f * sinf(t);
+    s.gyro[1] = 20.f * cosf(t);
+    s.gyro[2] = 5.f;
+    s.accel[0] = 10.f * sinf(0.5f * t);
+    s.accel[1] = -8.f;
+    s.accel[2] = 250.f;
+  }
+
+  AttitudeEstimator estimator;
+  timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(int i = 0; i < numSamples; i++){
+    ImuSample& s = samples[i % k_period];
+    s.stamp = (long long)i * 20000000LL;
+    estimator.update(s);
+    if(i % 25 == 0)
+      estimator.resetPreintegration();
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+  float roll, pitch, yaw;
+  estimator.eulerAngles(roll, pitch, yaw);
+  std::cout << "samples:        " << numSamples << std::endl;
+  std::cout << "ns per sample:  " << elapsed * 1e9 / numSamples << std::endl;
+  std::cout << "final attitude: " << roll << " " << pitch << " " << yaw << std::endl;
+  return 0;
+}
@@ -0,0 +1,391 @@
+/*
+ * microBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Microbenchmarks of the per-message paths of bbLog over synthetic input:
+ * event dispatch, serial line framing, IMU line handling and log record
+ * formatting. Each benchmark is timed over --runs runs of at least
+ * --min-time milliseconds; the median run is compared, since the fastest
+ * one on its own moves with every lucky or unlucky run.
+ *
+ * Results are written to --out as JSON, one benchmark per line. Given a
+ * --baseline written by an earlier run (on the same machine), every median
+ * is compared against the baseline's and the exit status is 1 if any
+ * benchmark got slower by more than --threshold percent. A benchmark over
+ * the threshold is measured again twice and only counts as a regression if
+ * it is over the threshold every time. An unoptimised build refuses to
+ * compare, as its numbers say nothing about the release build.
+ *
+ * Usage: microBench [--out=FILE] [--baseline=FILE] [--threshold=PCT]
+ *                   [--min-time=MS] [--runs=N] [--filter=TEXT]
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/scoped_array.hpp>
+
+#include "serial/LineFramer.h"
+#include "events/Event.hpp"
+#include "imu/ImuSample.h"
+#include "imu/ImuLineListener.h"
+#include "log/LogWriter.h"
+
+typedef unsigned long long (*BenchFunction)(unsigned long long iterations, int arg);
+
+struct Benchmark{
+  const char *name;
+  BenchFunction run;
+  int arg;
+};
+
+struct BenchResult{
+  std::string name;
+  unsigned long long iterations;
+  double minNs;
+  double medianNs;
+};
+
+/* ************************************************************************* */
+// Synthetic input, built once before anything is timed
+static std::vector<std::string> s_imuLines;
+static std::string s_imuStream;
+
+void BuildInput(){
+  const int k_lines = 256;
+  char line[160];
+  for(int i = 0; i < k_lines; i++){
+    int n;
+    if(i % 16 == 5)       // a line mangled by a dropped byte
+      n = snprintf(line, sizeof(line), "!ANG:%.2f,%.2f!ANG:1.00,2.00,3.00", 0.01 * i, -1.5);
+    else if(i % 16 == 11) // start-up chatter of the IMU
+      n = snprintf(line, sizeof(line), "Sparkfun 9DOF Razor AHRS %d", i);
+    else
+      n = snprintf(line, sizeof(line), "!ANG:%.2f,%.2f,%.2f,AN:%d,%d,%d,%d,%d,%d,%d,%d,%d",
+                   0.01 * (i % 300), -1.5, 0.1 * (i * 7 % 3600) - 180.0,
+                   (i % 17) - 8, 3, -2, 5, -7, 255, 100 + i, -40, 300);
+    s_imuLines.push_back(std::string(line, n));
+    s_imuStream.append(line, n);
+    s_imuStream.append("\r\n");
+  }
+}
+
+/* ************************************************************************* */
+class LineCounter{
+public:
+  LineCounter() : Lcount(this), total(0) {}
+  void count(const SerialLine& line){ total += line.length; }
+  LISTENER(LineCounter, count, const SerialLine&);
+  unsigned long long total;
+};
+
+// Event<T>::operator() with arg subscribers
+unsigned long long BenchEventDispatch(unsigned long long iterations, int arg){
+  Event<const SerialLine&> event;
+  // Listeners point at themselves, so they must not be copied
+  boost::scoped_array<LineCounter> counters(new LineCounter[arg]);
+  for(int i = 0; i < arg; i++)
+    event += &counters[i].Lcount;
+  SerialLine line;
+  line.data = s_imuLines[0].data();
+  for(unsigned long long i = 0; i < iterations; i++){
+    line.length = i & 63;
+    event(line);
+  }
+  unsigned long long sum = 0;
+  for(int i = 0; i < arg; i++)
+    sum += counters[i].total;
+  return sum;
+}
+
+/* ************************************************************************* */
+// Byte at a time framing of the event thread, per line
+unsigned long long BenchFrameEventThread(unsigned long long iterations, int){
+  LineFramer framer;
+  const char *data = s_imuStream.data();
+  size_t size = s_imuStream.size(), pos = 0;
+  unsigned long long sum = 0;
+  for(unsigned long long lines = 0; lines < iterations; ){
+    SerialLine line;
+    if(framer.push(data[pos], line) && line.length > 0){
+      sum += line.length + (unsigned char)line.data[0];
+      lines++;
+    }
+    if(++pos == size)
+      pos = 0;
+  }
+  return sum;
+}
+
+// Delimiter scan and copy of readUntil()/readln(), per line
+unsigned long long BenchFrameReadUntil(unsigned long long iterations, int){
+  const char *data = s_imuStream.data();
+  size_t size = s_imuStream.size(), pos = 0;
+  char buf[LineFramer::kMaxLineLength];
+  unsigned long long sum = 0;
+  for(unsigned long long lines = 0; lines < iterations; ){
+    size_t span = findDelimiter(data + pos, size - pos, "\r\n");
+    size_t take = std::min(span, sizeof(buf));
+    memcpy(buf, data + pos, take);
+    pos += span + 1;
+    if(pos >= size)
+      pos = 0;
+    if(take > 0){
+      sum += take + (unsigned char)buf[0];
+      lines++;
+    }
+  }
+  return sum;
+}
+
+/* ************************************************************************* */
+// The '!' check of the bbLog loop and parseImuLine(), per line
+unsigned long long BenchImuParse(unsigned long long iterations, int){
+  size_t count = s_imuLines.size();
+  unsigned long long sum = 0;
+  for(unsigned long long i = 0; i < iterations; i++){
+    const std::string& line = s_imuLines[i % count];
+    const char *p = line.data();
+    size_t length = line.size();
+    ImuSample sample;
+    if(p[0] == '!' && !memchr(p + 1, '!', length - 1) && parseImuLine(p, length, sample))
+      sum += sample.fields;
+  }
+  return sum;
+}
+
+class SampleSink{
+public:
+  SampleSink() : Lhandle(this), total(0) {}
+  void handle(const ImuSample& sample){ total += sample.fields; }
+  LISTENER(SampleSink, handle, const ImuSample&);
+  unsigned long long total;
+};
+
+// ImuLineListener: time stamp, parse and onSample dispatch, per line
+unsigned long long BenchImuListener(unsigned long long iterations, int){
+  ImuLineListener listener;
+  SampleSink sink;
+  listener.onSample += &sink.Lhandle;
+  size_t count = s_imuLines.size();
+  for(unsigned long long i = 0; i < iterations; i++){
+    const std::string& text = s_imuLines[i % count];
+    SerialLine line;
+    line.data = text.data();
+    line.length = text.size();
+    listener.handleLine(line);
+  }
+  return sink.total;
+}
+
+/* ************************************************************************* */
+// LogWriter records into /dev/null, so formatting dominates
+unsigned long long BenchLogText(unsigned long long iterations, int){
+  LogWriter log;
+  log.open("/dev/null");
+  size_t count = s_imuLines.size();
+  timespec stamp = { 1000, 0 };
+  long long utc = 1792413319000000000LL;
+  for(unsigned long long i = 0; i < iterations; i++){
+    const std::string& line = s_imuLines[i % count];
+    stamp.tv_nsec = (i * 20000000) % 1000000000;
+    log.write("imu", stamp, utc + i * 20000000, line.data(), line.size());
+  }
+  return log.size();
+}
+
+unsigned long long BenchLogValues(unsigned long long iterations, int){
+  LogWriter log;
+  log.open("/dev/null");
+  timespec stamp = { 1000, 0 };
+  float values[3] = { 1.5f, -0.25f, 179.875f };
+  for(unsigned long long i = 0; i < iterations; i++){
+    stamp.tv_nsec = (i * 20000000) % 1000000000;
+    values[2] = 0.01f * (i % 36000) - 180.0f;
+    log.writeValues("att", stamp, values, 3);
+  }
+  return log.size();
+}
+
+static const Benchmark k_benchmarks[] = {
+  { "event_dispatch_1", BenchEventDispatch, 1 },
+  { "event_dispatch_4", BenchEventDispatch, 4 },
+  { "event_dispatch_16", BenchEventDispatch, 16 },
+  { "frame_event_thread", BenchFrameEventThread, 0 },
+  { "frame_read_until", BenchFrameReadUntil, 0 },
+  { "imu_parse", BenchImuParse, 0 },
+  { "imu_listener", BenchImuListener, 0 },
+  { "log_write_text", BenchLogText, 0 },
+  { "log_write_values", BenchLogValues, 0 }
+};
+
+/* ************************************************************************* */
+volatile unsigned long long g_sink;
+
+double TimeRun(const Benchmark& bench, unsigned long long iterations){
+  timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  g_sink += bench.run(iterations, bench.arg);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+BenchResult RunBenchmark(const Benchmark& bench, double minSeconds, int runs){
+  // Grow the iteration count until one run takes at least minSeconds
+  unsigned long long iterations = 1000;
+  double elapsed = TimeRun(bench, iterations);
+  while(elapsed < minSeconds){
+    double scale = elapsed > 0 ? 1.2 * minSeconds / elapsed : 10;
+    iterations = (unsigned long long)(iterations * std::min(std::max(scale, 2.0), 100.0));
+    elapsed = TimeRun(bench, iterations);
+  }
+  std::vector<double> ns;
+  for(int r = 0; r < runs; r++)
+    ns.push_back(TimeRun(bench, iterations) * 1e9 / iterations);
+  std::sort(ns.begin(), ns.end());
+
+  BenchResult result;
+  result.name = bench.name;
+  result.iterations = iterations;
+  result.minNs = ns[0];
+  result.medianNs = ns[ns.size() / 2];
+  return result;
+}
+
+/* ************************************************************************* */
+bool WriteResults(const std::string& path, const std::vector<BenchResult>& results){
+  FILE *out = fopen(path.c_str(), "w");
+  if(!out)
+    return false;
+  fprintf(out, "{\n  \"benchmarks\": [\n");
+  for(size_t i = 0; i < results.size(); i++){
+    const BenchResult& r = results[i];
+    fprintf(out, "    { \"name\": \"%s\", \"iterations\": %llu, \"min_ns_per_op\": %.3f, \"median_ns_per_op\": %.3f }%s\n",
+            r.name.c_str(), r.iterations, r.minNs, r.medianNs, i + 1 < results.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  return fclose(out) == 0;
+}
+
+// Reads back what WriteResults() wrote: name -> median_ns_per_op
+bool ReadBaseline(const std::string& path, std::map<std::string, double>& baseline){
+  FILE *in = fopen(path.c_str(), "r");
+  if(!in)
+    return false;
+  char line[512];
+  while(fgets(line, sizeof(line), in)){
+    const char *name = strstr(line, "\"name\"");
+    const char *value = strstr(line, "\"median_ns_per_op\"");
+    if(!name || !value)
+      continue;
+    const char *begin = strchr(name + 6, '"');
+    const char *end = begin ? strchr(begin + 1, '"') : 0;
+    const char *colon = strchr(value + 18, ':');
+    if(!end || !colon)
+      continue;
+    baseline[std::string(begin + 1, end)] = strtod(colon + 1, 0);
+  }
+  fclose(in);
+  return true;
+}
+
+/* ************************************************************************* */
+void PrintUsage(){
+  std::cout << "Usage: microBench [options]" << std::endl
+            << "  --out=FILE       write the results as JSON" << std::endl
+            << "  --baseline=FILE  compare against an earlier --out file" << std::endl
+            << "  --threshold=PCT  slowdown against the baseline that fails (default 30)" << std::endl
+            << "  --min-time=MS    shortest timed run (default 100)" << std::endl
+            << "  --runs=N         timed runs per benchmark (default 11)" << std::endl
+            << "  --filter=TEXT    only run benchmarks whose name contains TEXT" << std::endl;
+}
+
+/* ************************************************************************* */
+// Times a benchmark that looks slower than the baseline is measured again;
+// it only counts as a regression if every measurement is over the threshold
+const int k_retries = 2;
+
+int main(int argc, char *argv[]){
+  std::string outPath, baselinePath, filter;
+  double threshold = 30;
+  double minMs = 100;
+  int runs = 11;
+  for(int i = 1; i < argc; i++){
+    if(strncmp(argv[i], "--out=", 6) == 0)
+      outPath = argv[i] + 6;
+    else if(strncmp(argv[i], "--baseline=", 11) == 0)
+      baselinePath = argv[i] + 11;
+    else if(strncmp(argv[i], "--threshold=", 12) == 0)
+      threshold = atof(argv[i] + 12);
+    else if(strncmp(argv[i], "--min-time=", 11) == 0 && (minMs = atof(argv[i] + 11)) > 0)
+      ;
+    else if(strncmp(argv[i], "--runs=", 7) == 0 && (runs = atoi(argv[i] + 7)) > 0)
+      ;
+    else if(strncmp(argv[i], "--filter=", 9) == 0)
+      filter = argv[i] + 9;
+    else{
+      PrintUsage();
+      return -1;
+    }
+  }
+
+#ifndef __OPTIMIZE__
+  std::cout << "Built without optimisation, configure with CMAKE_BUILD_TYPE=Release to benchmark" << std::endl;
+  if(!baselinePath.empty())
+    return 2;
+#endif
+
+  std::map<std::string, double> baseline;
+  bool haveBaseline = !baselinePath.empty() && ReadBaseline(baselinePath, baseline);
+  if(!baselinePath.empty() && !haveBaseline)
+    std::cout << "No baseline at " << baselinePath << ", nothing to compare against" << std::endl;
+
+  BuildInput();
+  std::vector<BenchResult> results;
+  int regressions = 0;
+  printf("%-20s %12s %12s %12s %8s\n", "benchmark", "min ns/op", "median", "baseline", "change");
+  for(size_t i = 0; i < sizeof(k_benchmarks) / sizeof(Benchmark); i++){
+    const Benchmark& bench = k_benchmarks[i];
+    if(!filter.empty() && !strstr(bench.name, filter.c_str()))
+      continue;
+    BenchResult r = RunBenchmark(bench, minMs * 1e-3, runs);
+    results.push_back(r);
+
+    std::map<std::string, double>::const_iterator base = baseline.find(r.name);
+    if(base == baseline.end() || base->second <= 0){
+      printf("%-20s %12.2f %12.2f %12s %8s\n", r.name.c_str(), r.minNs, r.medianNs, "-", "-");
+      continue;
+    }
+    double change = (r.medianNs / base->second - 1) * 100;
+    // A slowdown that is real survives being measured again, one caused by
+    // other load on the machine usually does not
+    for(int retry = 0; retry < k_retries && change > threshold; retry++){
+      BenchResult again = RunBenchmark(bench, minMs * 1e-3, runs);
+      if(again.medianNs < r.medianNs)
+        results.back() = r = again;
+      change = (r.medianNs / base->second - 1) * 100;
+    }
+    bool regressed = change > threshold;
+    regressions += regressed;
+    printf("%-20s %12.2f %12.2f %12.2f %+7.1f%%%s\n", r.name.c_str(), r.minNs, r.medianNs,
+           base->second, change, regressed ? "  REGRESSED" : "");
+  }
+
+  if(!outPath.empty() && !WriteResults(outPath, results)){
+    std::cerr << "Failed to write " << outPath << std::endl;
+    return -1;
+  }
+  if(regressions){
+    std::cout << regressions << " benchmark(s) slower than the baseline by more than "
+              << threshold << "% in " << k_retries + 1 << " measurements" << std::endl;
+    return 1;
+  }
+  return 0;
+}
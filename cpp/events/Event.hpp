@@ -39,6 +39,10 @@ class Event
                 }
             }
         }
+        inline bool empty() const
+        {
+            return _delegates.empty();
+        }
         inline void operator()(T param)
         {
             typedef typename std::vector< Delegate<T>* >::iterator iter;
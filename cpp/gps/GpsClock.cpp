@@ -0,0 +1,124 @@
+/*
+ * GpsClock.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "GpsClock.h"
+#include <math.h>
+#include <string.h>
+
+// Below this spread of local times the drift is not observable yet
+static const double kMinSxx = 1e-6;
+
+GpsClock::GpsClock(double halfLifeSeconds, double rejectSigma, double minResidual)
+    : _halfLife(halfLifeSeconds), _rejectSigma(rejectSigma), _minResidual(minResidual)
+{
+    reset();
+}
+
+void GpsClock::reset() {
+    boost::mutex::scoped_lock lock(_lock);
+    _reference = 0;
+    _baseOffset = 0;
+    _samples = 0;
+    _rejections = 0;
+    memset(&_state, 0, sizeof(_state));
+}
+
+void GpsClock::restart(long long utc, long long local) {
+    _reference = local;
+    _baseOffset = utc - local;
+    _lastX = 0;
+    _weight = 0;
+    _meanX = 0;
+    _meanY = 0;
+    _sxx = 0;
+    _sxy = 0;
+    _residualSquare = 0;
+    _residualWeight = 0;
+    _samples = 0;
+    _rejections = 0;
+    _state.valid = false;
+    _state.drift = 0;
+}
+
+double GpsClock::predict(double x) const {
+    double drift = _sxx > kMinSxx ? _sxy / _sxx : 0;
+    return _meanY + drift * (x - _meanX);
+}
+
+bool GpsClock::add(long long utc, long long local) {
+    boost::mutex::scoped_lock lock(_lock);
+    if(_samples == 0)
+        restart(utc, local);
+    double x = (local - _reference) * 1e-9;
+    double y = (utc - local - _baseOffset) * 1e-9;
+
+    double residual = y - predict(x);
+    _state.lastResidual = residual;
+    if(_samples >= kMinSamples && _residualWeight >= kMinSamples)
+    {
+        double limit = _rejectSigma * sqrt(_residualSquare);
+        if(limit < _minResidual)
+            limit = _minResidual;
+        if(fabs(residual) > limit)
+        {
+            _state.rejected++;
+            if(++_rejections < kMaxRejections)
+                return false;
+            // Not an outlier but a step: start over from here
+            _state.resets++;
+            restart(utc, local);
+            x = 0;
+            y = 0;
+            residual = 0;
+        }
+    }
+    _rejections = 0;
+
+    // Exponentially weighted means and co-moments (weighted Welford)
+    double decay = x > _lastX ? pow(0.5, (x - _lastX) / _halfLife) : 1.0;
+    _lastX = x;
+    _weight = decay * _weight + 1;
+    double dx = x - _meanX;
+    _meanX += dx / _weight;
+    _meanY += (y - _meanY) / _weight;
+    _sxx = decay * _sxx + dx * (x - _meanX);
+    _sxy = decay * _sxy + dx * (y - _meanY);
+    // The spread only counts residuals against a locked fit, and over the
+    // last kResidualSamples or so: residuals from while the line converges
+    // are large and would otherwise keep the limit loose for a half-life
+    if(_samples >= kMinSamples)
+    {
+        _residualWeight = decay * _residualWeight + 1;
+        if(_residualWeight > kResidualSamples)
+            _residualWeight = kResidualSamples;
+        _residualSquare += (residual * residual - _residualSquare) / _residualWeight;
+    }
+    _samples++;
+
+    _state.accepted++;
+    _state.valid = _samples >= kMinSamples;
+    _state.drift = _sxx > kMinSxx ? _sxy / _sxx : 0;
+    _state.residualRms = sqrt(_residualSquare);
+    return true;
+}
+
+long long GpsClock::toUtc(long long local) const {
+    boost::mutex::scoped_lock lock(_lock);
+    if(_samples < kMinSamples)
+        return -1;
+    double correction = predict((local - _reference) * 1e-9);
+    return local + _baseOffset + (long long)floor(correction * 1e9 + 0.5);
+}
+
+bool GpsClock::valid() const {
+    boost::mutex::scoped_lock lock(_lock);
+    return _state.valid;
+}
+
+GpsClockState GpsClock::state() const {
+    boost::mutex::scoped_lock lock(_lock);
+    return _state;
+}
@@ -0,0 +1,101 @@
+/*
+ * GpsClock.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef GPSCLOCK_H_
+#define GPSCLOCK_H_
+
+#include <boost/thread/mutex.hpp>
+
+/**
+ * Snapshot of a GpsClock, see GpsClock::state().
+ */
+struct GpsClockState {
+    bool valid;
+    double drift;               // seconds per second the local clock runs slow
+    double residualRms;         // seconds, over the accepted samples
+    double lastResidual;        // seconds, of the last sample added
+    unsigned long long accepted;
+    unsigned long long rejected;
+    unsigned long long resets;
+};
+
+/**
+ * Model of UTC against a local clock (CLOCK_MONOTONIC in bbLog), disciplined
+ * by GPS time:
+ *
+ *   utc = local + offset + drift * (local - reference)
+ *
+ * Every GPS time is fed to add() with the local time its sentence arrived.
+ * offset and drift are a least-squares line through the samples, weighted
+ * by a forgetting factor with a half-life of halfLifeSeconds, so the fit
+ * follows the oscillator as it warms up. A sample further from the line
+ * than rejectSigma times the residual spread (and at least minResidual
+ * seconds) is an outlier and is dropped, eg. a sentence that sat in a
+ * buffer. The spread is taken over the last kResidualSamples or so
+ * residuals against the locked fit, and outliers are looked for once
+ * kMinSamples of them are in.
+ * kMaxRejections outliers in a row mean a step (receiver or clock reset)
+ * and the fit starts over from the last one.
+ *
+ * The constant latency from the GPS epoch to the sentence arriving ends up
+ * in the offset. add() and toUtc() take constant time and do not allocate;
+ * they can be called from different threads.
+ */
+class GpsClock {
+public:
+    static const unsigned int kMinSamples = 4;
+    static const unsigned int kMaxRejections = 5;
+    static const unsigned int kResidualSamples = 60;
+
+    GpsClock(double halfLifeSeconds = 600, double rejectSigma = 4, double minResidual = 0.002);
+
+    /**
+     * Adds a GPS time and the local time it arrived, both in nanoseconds.
+     * Returns false if the sample was rejected as an outlier.
+     */
+    bool add(long long utc, long long local);
+
+    /**
+     * UTC in nanoseconds since 1970 of a local time, or -1 until
+     * kMinSamples samples have been accepted.
+     */
+    long long toUtc(long long local) const;
+
+    bool valid() const;
+    GpsClockState state() const;
+
+    /**
+     * Forgets all samples.
+     */
+    void reset();
+
+private:
+    double _halfLife;
+    double _rejectSigma;
+    double _minResidual;
+
+    mutable boost::mutex _lock;
+    // Samples are kept as x = local - _reference and y = utc - local - _baseOffset,
+    // in seconds, so the sums stay small enough for doubles
+    long long _reference;
+    long long _baseOffset;
+    double _lastX;
+    double _weight;
+    double _meanX;
+    double _meanY;
+    double _sxx;
+    double _sxy;
+    double _residualSquare;
+    double _residualWeight;
+    unsigned int _samples;
+    unsigned int _rejections;
+    GpsClockState _state;
+
+    void restart(long long utc, long long local);
+    double predict(double x) const;
+};
+
+#endif /* GPSCLOCK_H_ */
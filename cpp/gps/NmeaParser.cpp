@@ -0,0 +1,220 @@
+/*
+ * NmeaParser.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "NmeaParser.h"
+#include <string.h>
+
+static const int kMaxFields = 20;
+static const float kKnotsToMetresPerSecond = 0.514444f;
+
+struct Field {
+    const char *begin;
+    const char *end;
+    bool empty() const { return begin == end; }
+};
+
+static int hexDigit(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Plain decimal without exponent, as NMEA uses
+static bool parseDecimal(const Field& f, double& value) {
+    const char *p = f.begin;
+    bool negative = false;
+    if(p < f.end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+    double v = 0;
+    bool digits = false;
+    while(p < f.end && *p >= '0' && *p <= '9')
+    {
+        v = v * 10 + (*p++ - '0');
+        digits = true;
+    }
+    if(p < f.end && *p == '.')
+    {
+        p++;
+        double scale = 0.1;
+        while(p < f.end && *p >= '0' && *p <= '9')
+        {
+            v += (*p++ - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+        }
+    }
+    if(!digits || p != f.end)
+        return false;
+    value = negative ? -v : v;
+    return true;
+}
+
+static bool parseDigits(const char *p, int count, int& value) {
+    value = 0;
+    for(int i = 0; i < count; i++)
+    {
+        if(p[i] < '0' || p[i] > '9')
+            return false;
+        value = value * 10 + (p[i] - '0');
+    }
+    return true;
+}
+
+// ddmm.mmmm / dddmm.mmmm plus hemisphere to signed degrees
+static bool parseAngle(const Field& value, const Field& hemisphere, double& degrees) {
+    double raw;
+    if(!parseDecimal(value, raw) || hemisphere.empty())
+        return false;
+    int whole = (int)(raw / 100);
+    degrees = whole + (raw - whole * 100) / 60.0;
+    if(*hemisphere.begin == 'S' || *hemisphere.begin == 'W')
+        degrees = -degrees;
+    return true;
+}
+
+// hhmmss.ss to seconds since midnight
+static bool parseTime(const Field& f, double& seconds) {
+    int hours, minutes;
+    double secs;
+    if(f.end - f.begin < 6 || !parseDigits(f.begin, 2, hours) || !parseDigits(f.begin + 2, 2, minutes))
+        return false;
+    Field rest = { f.begin + 4, f.end };
+    if(!parseDecimal(rest, secs))
+        return false;
+    seconds = hours * 3600.0 + minutes * 60.0 + secs;
+    return true;
+}
+
+GpsFix emptyGpsFix() {
+    GpsFix fix;
+    memset(&fix, 0, sizeof(fix));
+    return fix;
+}
+
+unsigned char parseNmeaLine(const char *line, size_t length, GpsFix& fix) {
+    if(length < 7 || line[0] != '$')
+        return 0;
+
+    // Checksum is the XOR of everything between '$' and '*'
+    const char *end = line + length;
+    const char *star = (const char *)memchr(line, '*', length);
+    if(star)
+    {
+        if(end - star < 3)
+            return 0;
+        unsigned char sum = 0;
+        for(const char *p = line + 1; p < star; p++)
+            sum ^= (unsigned char)*p;
+        int hi = hexDigit(star[1]), lo = hexDigit(star[2]);
+        if(hi < 0 || lo < 0 || sum != (unsigned char)(hi * 16 + lo))
+            return 0;
+        end = star;
+    }
+
+    Field fields[kMaxFields];
+    int n = 0;
+    const char *p = line + 1;
+    while(n < kMaxFields)
+    {
+        const char *comma = (const char *)memchr(p, ',', end - p);
+        fields[n].begin = p;
+        fields[n].end = comma ? comma : end;
+        n++;
+        if(!comma)
+            break;
+        p = comma + 1;
+    }
+
+    // Talker can be GP, GN, GL...; only the sentence type matters
+    const Field& type = fields[0];
+    if(type.end - type.begin != 5)
+        return 0;
+    unsigned char updated = 0;
+    double v;
+    if(memcmp(type.begin + 2, "GGA", 3) == 0 && n >= 10)
+    {
+        double seconds, lat, lon;
+        int quality = 0;
+        if(fields[6].empty() || !parseDigits(fields[6].begin, 1, quality) || quality == 0)
+            return 0;
+        if(!parseAngle(fields[2], fields[3], lat) || !parseAngle(fields[4], fields[5], lon))
+            return 0;
+        fix.latitude = lat;
+        fix.longitude = lon;
+        fix.fixQuality = (unsigned char)quality;
+        updated |= GPS_HAS_POSITION;
+        if(parseDecimal(fields[7], v))
+            fix.satellites = (unsigned char)v;
+        if(parseDecimal(fields[9], v))
+        {
+            fix.altitude = (float)v;
+            updated |= GPS_HAS_ALTITUDE;
+        }
+        if(parseTime(fields[1], seconds))
+        {
+            fix.utcSeconds = seconds;
+            updated |= GPS_HAS_TIME;
+        }
+    }
+    else if(memcmp(type.begin + 2, "RMC", 3) == 0 && n >= 10)
+    {
+        double seconds, lat, lon;
+        if(fields[2].empty() || *fields[2].begin != 'A')
+            return 0;
+        if(parseAngle(fields[3], fields[4], lat) && parseAngle(fields[5], fields[6], lon))
+        {
+            fix.latitude = lat;
+            fix.longitude = lon;
+            updated |= GPS_HAS_POSITION;
+        }
+        if(parseDecimal(fields[7], v))
+        {
+            fix.speed = (float)v * kKnotsToMetresPerSecond;
+            fix.course = 0;
+            if(parseDecimal(fields[8], v))
+                fix.course = (float)v;
+            updated |= GPS_HAS_VELOCITY;
+        }
+        if(parseTime(fields[1], seconds))
+        {
+            fix.utcSeconds = seconds;
+            updated |= GPS_HAS_TIME;
+        }
+        int day, month, year;
+        if(fields[9].end - fields[9].begin == 6 && parseDigits(fields[9].begin, 2, day) &&
+           parseDigits(fields[9].begin + 2, 2, month) && parseDigits(fields[9].begin + 4, 2, year))
+        {
+            fix.day = day;
+            fix.month = month;
+            fix.year = 2000 + year;
+            updated |= GPS_HAS_DATE;
+        }
+    }
+    fix.fields |= updated;
+    return updated;
+}
+
+// Days from 1970-01-01 to a proleptic Gregorian date
+static long long daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    long long yearOfEra = year - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+bool gpsFixUtc(const GpsFix& fix, long long& utc) {
+    if((fix.fields & (GPS_HAS_TIME | GPS_HAS_DATE)) != (GPS_HAS_TIME | GPS_HAS_DATE))
+        return false;
+    if(fix.month < 1 || fix.month > 12 || fix.day < 1 || fix.day > 31)
+        return false;
+    long long wholeSeconds = (long long)fix.utcSeconds;
+    long long nanoseconds = (long long)((fix.utcSeconds - wholeSeconds) * 1e9 + 0.5);
+    utc = (daysFromCivil(fix.year, fix.month, fix.day) * 86400LL + wholeSeconds) * 1000000000LL + nanoseconds;
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+ * NmeaParser.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef NMEAPARSER_H_
+#define NMEAPARSER_H_
+
+#include <stddef.h>
+
+/**
+ * Flags telling which parts of a GpsFix have been filled in.
+ */
+enum GpsFields {
+    GPS_HAS_POSITION = 0x01,
+    GPS_HAS_ALTITUDE = 0x02,
+    GPS_HAS_VELOCITY = 0x04,
+    GPS_HAS_TIME     = 0x08,
+    GPS_HAS_DATE     = 0x10
+};
+
+/**
+ * GPS state accumulated from NMEA sentences. GGA fills in position,
+ * altitude, fix quality and satellites; RMC position, velocity, time and date.
+ */
+struct GpsFix {
+    long long stamp;        // nanoseconds on the logging clock when the sentence arrived
+    double latitude;        // degrees, north positive
+    double longitude;       // degrees, east positive
+    float altitude;         // metres above mean sea level
+    float speed;            // metres per second over ground
+    float course;           // degrees from true north
+    double utcSeconds;      // UTC seconds since midnight of the sentence
+    int year;
+    int month;
+    int day;
+    unsigned char fixQuality;   // 0 no fix, 1 GPS, 2 DGPS
+    unsigned char satellites;
+    unsigned char fields;
+};
+
+/**
+ * Returns a GpsFix with nothing filled in.
+ */
+GpsFix emptyGpsFix();
+
+/**
+ * Parses one NMEA sentence (without the newline) and updates fix with what it carries.
+ * Returns the number of GpsFields bits updated, or 0 if the sentence is not a
+ * GGA or RMC sentence, has a bad checksum, or reports no fix. Leaves fix.stamp
+ * untouched. Does not allocate.
+ */
+unsigned char parseNmeaLine(const char *line, size_t length, GpsFix& fix);
+
+/**
+ * UTC of the time and date of fix, in nanoseconds since 1970.
+ * Returns false unless both are set. GGA carries no date, so only the
+ * fields updated by one RMC sentence are sure to belong together.
+ */
+bool gpsFixUtc(const GpsFix& fix, long long& utc);
+
+#endif /* NMEAPARSER_H_ */
@@ -0,0 +1,144 @@
+/*
+ * AttitudeEstimator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "AttitudeEstimator.h"
+
+static const float kGravity = 9.80665f;
+
+// Steps longer than this are treated as a gap in the IMU stream
+static const double kMaxStep = 0.1;
+
+const double AttitudeEstimator::kMaxLag = 0.5;
+
+// Only trust the accelerometer as a gravity reference near 1g
+static const float kMinAccelNorm = 0.5f * kGravity;
+static const float kMaxAccelNorm = 1.5f * kGravity;
+
+static const unsigned int kNormalizeInterval = 16;
+
+ImuCalibration::ImuCalibration() {
+    for(int i = 0; i < 3; i++)
+    {
+        gyroOffset[i] = 0;
+        accelOffset[i] = 0;
+    }
+    gyroScale = (float)(M_PI / 180.0 / 14.375);
+    accelScale = kGravity / 256.f;
+}
+
+AttitudeEstimator::AttitudeEstimator(const ImuCalibration& calibration, float kp, float ki)
+    : Lupdate(this), _cal(calibration), _kp(kp), _ki(ki),
+      _R(Matrix3f::identity()), _bias(Vector3f::zeros()),
+      _lastStamp(0), _nominalStep(0), _initialized(false), _sinceNormalize(0)
+{
+    resetPreintegration();
+}
+
+void AttitudeEstimator::setNominalRate(double hz) {
+    _nominalStep = hz > 0 ? (long long)(1e9 / hz + 0.5) : 0;
+}
+
+void AttitudeEstimator::resetPreintegration() {
+    _preint.deltaR = Matrix3f::identity();
+    _preint.deltaV = Vector3f::zeros();
+    _preint.deltaP = Vector3f::zeros();
+    _preint.deltaT = 0;
+    _preint.count = 0;
+}
+
+void AttitudeEstimator::update(const ImuSample& sample) {
+    if(!(sample.fields & IMU_HAS_GYRO))
+        return;
+
+    Vector3f gyro = vector3((sample.gyro[0] - _cal.gyroOffset[0]) * _cal.gyroScale,
+                            (sample.gyro[1] - _cal.gyroOffset[1]) * _cal.gyroScale,
+                            (sample.gyro[2] - _cal.gyroOffset[2]) * _cal.gyroScale);
+    bool hasAccel = (sample.fields & IMU_HAS_ACCEL) != 0;
+    Vector3f accel = Vector3f::zeros();
+    if(hasAccel)
+        accel = vector3((sample.accel[0] - _cal.accelOffset[0]) * _cal.accelScale,
+                        (sample.accel[1] - _cal.accelOffset[1]) * _cal.accelScale,
+                        (sample.accel[2] - _cal.accelOffset[2]) * _cal.accelScale);
+
+    if(!_initialized)
+    {
+        _lastStamp = sample.stamp;
+        _initialized = true;
+        return;
+    }
+    double dt;
+    if(_nominalStep > 0)
+    {
+        long long lag = sample.stamp - _lastStamp;
+        long long step = lag;
+        if(step < _nominalStep / 2)
+            step = _nominalStep / 2;
+        else if(step > _nominalStep + _nominalStep / 2)
+            step = _nominalStep + _nominalStep / 2;
+        if(lag > kMaxLag * 1e9 || lag < -kMaxLag * 1e9)
+        {
+            step = _nominalStep;
+            _lastStamp = sample.stamp;
+        }
+        else
+            _lastStamp += step;
+        dt = step * 1e-9;
+    }
+    else
+    {
+        dt = (sample.stamp - _lastStamp) * 1e-9;
+        _lastStamp = sample.stamp;
+        if(dt <= 0 || dt > kMaxStep)
+            return;
+    }
+    float fdt = (float)dt;
+
+    // Gravity correction: the accelerometer should read +g along world up
+    Vector3f omega = gyro + _bias;
+    float accelNorm = norm(accel);
+    if(hasAccel && accelNorm > kMinAccelNorm && accelNorm < kMaxAccelNorm)
+    {
+        Vector3f measured = accel * (1.f / accelNorm);
+        Vector3f predicted = vector3(_R.m[2][0], _R.m[2][1], _R.m[2][2]);
+        Vector3f error = cross(measured, predicted);
+        _bias += error * (_ki * fdt);
+        omega = gyro + _bias + error * _kp;
+    }
+    _R = _R * expSO3(omega * fdt);
+    if(++_sinceNormalize >= kNormalizeInterval)
+    {
+        orthonormalize(_R);
+        _sinceNormalize = 0;
+    }
+
+    // Preintegration uses the bias-corrected rates but no gravity correction
+    Vector3f unbiased = gyro + _bias;
+    Vector3f dv = _preint.deltaR * accel;
+    _preint.deltaP += _preint.deltaV * fdt + dv * (0.5f * fdt * fdt);
+    _preint.deltaV += dv * fdt;
+    _preint.deltaR = _preint.deltaR * expSO3(unbiased * fdt);
+    _preint.deltaT += dt;
+    _preint.count++;
+}
+
+void AttitudeEstimator::eulerAngles(float& roll, float& pitch, float& yaw) const {
+    roll = atan2f(_R.m[2][1], _R.m[2][2]);
+    float s = -_R.m[2][0];
+    pitch = asinf(s > 1.f ? 1.f : (s < -1.f ? -1.f : s));
+    yaw = atan2f(_R.m[1][0], _R.m[0][0]);
+}
+
+void flattenPreintegration(const ImuPreintegration& preint, float *values) {
+    *values++ = (float)preint.deltaT;
+    *values++ = (float)preint.count;
+    for(int r = 0; r < 3; r++)
+        for(int c = 0; c < 3; c++)
+            *values++ = preint.deltaR.m[r][c];
+    for(int i = 0; i < 3; i++)
+        *values++ = preint.deltaV[i];
+    for(int i = 0; i < 3; i++)
+        *values++ = preint.deltaP[i];
+}
@@ -0,0 +1,130 @@
+/*
+ * AttitudeEstimator.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ATTITUDEESTIMATOR_H_
+#define ATTITUDEESTIMATOR_H_
+
+#include <events/Delegate.hpp>
+#include <math/Matrix.hpp>
+#include "ImuSample.h"
+
+/**
+ * Converts the raw AN: values of the IMU to SI units: si = (raw - offset) * scale.
+ * The defaults match the ITG-3200 gyro (14.375 LSB per deg/s) and the
+ * ADXL345 accelerometer at 256 LSB per g of the Razor IMU.
+ */
+struct ImuCalibration {
+    float gyroOffset[3];
+    float gyroScale;    // rad/s per LSB
+    float accelOffset[3];
+    float accelScale;   // m/s^2 per LSB
+
+    ImuCalibration();
+};
+
+/**
+ * Gyro and accelerometer measurements integrated between two instants,
+ * expressed in the body frame at the start of the interval.
+ */
+struct ImuPreintegration {
+    Matrix3f deltaR;
+    Vector3f deltaV;
+    Vector3f deltaP;
+    double deltaT;
+    unsigned int count;
+};
+
+/**
+ * Number of values flattenPreintegration() writes.
+ */
+static const int kPreintegrationValues = 17;
+
+/**
+ * Flattens a preintegration for a log record: deltaT, count, deltaR row by
+ * row, deltaV, deltaP.
+ */
+void flattenPreintegration(const ImuPreintegration& preint, float *values);
+
+/**
+ * Streaming attitude estimator running at the full IMU rate.
+ *
+ * A complementary (Mahony) filter on the body to world rotation matrix:
+ * gyro rates are integrated and the roll/pitch drift is pulled towards the
+ * gravity direction seen by the accelerometer, with an integral term that
+ * tracks gyro bias. Optionally accumulates a gyro/accelerometer
+ * preintegration between camera frames. Fixed-size math only, no allocation.
+ */
+class AttitudeEstimator {
+public:
+    AttitudeEstimator(const ImuCalibration& calibration = ImuCalibration(),
+                      float kp = 1.0f, float ki = 0.02f);
+
+    /**
+     * Integrates one sample. Samples without gyro data are ignored.
+     */
+    void update(const ImuSample& sample);
+
+    /**
+     * Integrates every sample over a step near the IMU's output period
+     * instead of the gap between stamps. Samples a stall delivers in a
+     * bunch are then spread out at up to 1.5 periods each until the
+     * stream has caught up with its stamps, rather than one long step
+     * being dropped as a gap. After more than kMaxLag off the stamps the
+     * stream is resynchronised. 0 goes back to stamp differences.
+     */
+    void setNominalRate(double hz);
+
+    /** How far integration may run behind or ahead of the stamps, in seconds. */
+    static const double kMaxLag;
+
+    /**
+     * Starts a new preintegration interval, typically at a camera frame.
+     */
+    void resetPreintegration();
+
+    /**
+     * Returns what has been preintegrated since the last reset.
+     */
+    const ImuPreintegration& preintegration() const { return _preint; }
+
+    /**
+     * Body to world rotation, world z pointing up.
+     */
+    const Matrix3f& rotation() const { return _R; }
+
+    /**
+     * Current roll, pitch and yaw in radians.
+     */
+    void eulerAngles(float& roll, float& pitch, float& yaw) const;
+
+    /**
+     * Current gyro bias correction in rad/s, added to the calibrated rates.
+     */
+    const Vector3f& gyroBias() const { return _bias; }
+
+    bool initialized() const { return _initialized; }
+
+    /**
+     * Listener so the estimator can subscribe to ImuLineListener::onSample.
+     */
+    LISTENER(AttitudeEstimator, update, const ImuSample&);
+
+private:
+    ImuCalibration _cal;
+    float _kp;
+    float _ki;
+
+    Matrix3f _R;
+    Vector3f _bias;
+    long long _lastStamp;   // integrated up to here, in nanoseconds
+    long long _nominalStep; // 0 without a nominal rate
+    bool _initialized;
+    unsigned int _sinceNormalize;
+
+    ImuPreintegration _preint;
+};
+
+#endif /* ATTITUDEESTIMATOR_H_ */
@@ -0,0 +1,181 @@
+/*
+ * ImuFrameAligner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ImuFrameAligner.h"
+#include <string.h>
+
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+// Interpolates angles in degrees along the short way around the circle
+static float lerpDegrees(float a, float b, float t) {
+    float d = b - a;
+    while(d > 180.f) d -= 360.f;
+    while(d < -180.f) d += 360.f;
+    float v = a + d * t;
+    if(v > 180.f) v -= 360.f;
+    if(v <= -180.f) v += 360.f;
+    return v;
+}
+
+static void interpolate(const ImuSample& a, const ImuSample& b, long long stamp, ImuSample& out) {
+    float t = (float)(stamp - a.stamp) / (float)(b.stamp - a.stamp);
+    out.stamp = stamp;
+    out.fields = a.fields & b.fields;
+    for(int i = 0; i < 3; i++)
+    {
+        out.euler[i] = lerpDegrees(a.euler[i], b.euler[i], t);
+        out.gyro[i] = lerp(a.gyro[i], b.gyro[i], t);
+        out.accel[i] = lerp(a.accel[i], b.accel[i], t);
+        out.mag[i] = lerp(a.mag[i], b.mag[i], t);
+    }
+}
+
+ImuFrameAligner::ImuFrameAligner(size_t sampleCapacity, size_t maxPendingFrames)
+    : _ring(sampleCapacity), _ringHead(0), _ringCount(0),
+      _pending(maxPendingFrames), _pendingHead(0), _pendingCount(0),
+      _lastFrameStamp(0), _truncated(false)
+{
+    _blockSamples.reserve(sampleCapacity);
+}
+
+const ImuSample& ImuFrameAligner::sampleAt(size_t i) const {
+    // i counts from the oldest sample in the ring
+    return _ring[(_ringHead + _ring.size() - _ringCount + i) % _ring.size()];
+}
+
+void ImuFrameAligner::addSample(const ImuSample& sample) {
+    if(_ringCount == _ring.size())
+    {
+        if(sampleAt(0).stamp > _lastFrameStamp)
+            _truncated = true;
+        _ringCount--;
+    }
+    _ring[_ringHead] = sample;
+    _ringHead = (_ringHead + 1) % _ring.size();
+    _ringCount++;
+
+    while(_pendingCount > 0 && _pending[_pendingHead] <= sample.stamp)
+        emitOldestPending();
+}
+
+void ImuFrameAligner::addFrame(long long frameStamp) {
+    if(_pendingCount == _pending.size())
+        emitOldestPending();
+    _pending[(_pendingHead + _pendingCount) % _pending.size()] = frameStamp;
+    _pendingCount++;
+
+    // The IMU may already be ahead of the camera
+    if(_ringCount > 0 && sampleAt(_ringCount - 1).stamp >= frameStamp)
+        emitOldestPending();
+}
+
+void ImuFrameAligner::flush() {
+    while(_pendingCount > 0)
+        emitOldestPending();
+}
+
+void ImuFrameAligner::emitOldestPending() {
+    ImuFrameBlock block;
+    block.frameStamp = _pending[_pendingHead];
+    _pendingHead = (_pendingHead + 1) % _pending.size();
+    _pendingCount--;
+
+    _blockSamples.clear();
+    const ImuSample *before = 0;
+    const ImuSample *after = 0;
+    for(size_t i = 0; i < _ringCount; i++)
+    {
+        const ImuSample& s = sampleAt(i);
+        if(s.stamp <= block.frameStamp)
+        {
+            before = &s;
+            if(s.stamp > _lastFrameStamp)
+                _blockSamples.push_back(s);
+        }
+        else
+        {
+            after = &s;
+            break;
+        }
+    }
+
+    block.flags = _truncated ? IMU_BLOCK_TRUNCATED : 0;
+    if(before && after)
+    {
+        interpolate(*before, *after, block.frameStamp, block.atFrame);
+        block.flags |= IMU_BLOCK_INTERPOLATED;
+    }
+    else if(before || after)
+    {
+        block.atFrame = before ? *before : *after;
+        block.flags |= IMU_BLOCK_HELD;
+    }
+    else
+    {
+        memset(&block.atFrame, 0, sizeof(block.atFrame));
+        block.flags |= IMU_BLOCK_NO_IMU;
+    }
+    block.atFrame.stamp = block.frameStamp;
+    block.samples = _blockSamples.empty() ? 0 : &_blockSamples[0];
+    block.count = _blockSamples.size();
+
+    _lastFrameStamp = block.frameStamp;
+    _truncated = false;
+    onFrameBlock(block);
+}
+
+/* ************************************************************************* */
+static const size_t kBlockHeaderSize = 4 + 8 + 2 + 1;
+static const size_t kMaxSampleSize = 4 + 1 + 4 * 4 * 3;
+
+size_t maxEncodedImuFrameBlockSize(size_t count) {
+    return kBlockHeaderSize + (count + 1) * kMaxSampleSize;
+}
+
+// Little endian whatever the host order, byte by byte
+static char *putLe(char *out, unsigned long long value, size_t size) {
+    for(size_t i = 0; i < size; i++)
+        *out++ = (char)(value >> (8 * i));
+    return out;
+}
+
+static char *putFloats(char *out, const float *values) {
+    for(int i = 0; i < 3; i++)
+    {
+        unsigned int bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        out = putLe(out, bits, 4);
+    }
+    return out;
+}
+
+static char *encodeSample(char *out, const ImuSample& s, long long frameStamp) {
+    int dt = (int)((s.stamp - frameStamp) / 1000);
+    out = putLe(out, (unsigned int)dt, 4);
+    out = putLe(out, s.fields, 1);
+    if(s.fields & IMU_HAS_EULER) out = putFloats(out, s.euler);
+    if(s.fields & IMU_HAS_GYRO)  out = putFloats(out, s.gyro);
+    if(s.fields & IMU_HAS_ACCEL) out = putFloats(out, s.accel);
+    if(s.fields & IMU_HAS_MAG)   out = putFloats(out, s.mag);
+    return out;
+}
+
+size_t encodeImuFrameBlock(const ImuFrameBlock& block, char *out, size_t capacity) {
+    if(capacity < maxEncodedImuFrameBlockSize(block.count) || block.count > 0xFFFF)
+        return 0;
+    char *p = out + 4;
+    p = putLe(p, (unsigned long long)block.frameStamp, 8);
+    p = putLe(p, block.count, 2);
+    p = putLe(p, block.flags, 1);
+    p = encodeSample(p, block.atFrame, block.frameStamp);
+    for(size_t i = 0; i < block.count; i++)
+        p = encodeSample(p, block.samples[i], block.frameStamp);
+    unsigned int length = (unsigned int)(p - out);
+    putLe(out, length, 4);
+    return length;
+}
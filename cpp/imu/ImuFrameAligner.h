@@ -0,0 +1,102 @@
+/*
+ * ImuFrameAligner.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef IMUFRAMEALIGNER_H_
+#define IMUFRAMEALIGNER_H_
+
+#include <vector>
+#include <events/Event.hpp>
+#include "ImuSample.h"
+
+/**
+ * Flags describing how an ImuFrameBlock was put together.
+ */
+enum ImuBlockFlags {
+    IMU_BLOCK_INTERPOLATED = 0x01,  // atFrame was interpolated between the samples around the frame
+    IMU_BLOCK_HELD         = 0x02,  // only one side was available, atFrame is the nearest sample
+    IMU_BLOCK_TRUNCATED    = 0x04,  // the ring overflowed and the oldest samples of the interval are gone
+    IMU_BLOCK_NO_IMU       = 0x08   // there was no IMU data at all
+};
+
+/**
+ * The IMU data belonging to one camera frame: the IMU state at the frame
+ * timestamp and every sample received since the previous frame.
+ * samples points into the aligner and is only valid during onFrameBlock.
+ */
+struct ImuFrameBlock {
+    long long frameStamp;
+    ImuSample atFrame;
+    const ImuSample *samples;
+    size_t count;
+    unsigned char flags;
+};
+
+/**
+ * Streams IMU samples and frame timestamps into per-frame IMU blocks.
+ *
+ * Samples are kept in a fixed-size ring and all storage is allocated in the
+ * constructor. A frame is held back until the first sample after it arrives
+ * so its IMU state can be interpolated; if more than maxPendingFrames frames
+ * are waiting, the oldest is emitted with the last sample before it.
+ */
+class ImuFrameAligner {
+public:
+    ImuFrameAligner(size_t sampleCapacity = 512, size_t maxPendingFrames = 4);
+
+    /**
+     * Adds an IMU sample. Samples must arrive in timestamp order.
+     */
+    void addSample(const ImuSample& sample);
+
+    /**
+     * Adds the timestamp of a captured frame. Frames must arrive in timestamp order.
+     */
+    void addFrame(long long frameStamp);
+
+    /**
+     * Emits every pending frame with the samples received so far.
+     */
+    void flush();
+
+    Event<const ImuFrameBlock&> onFrameBlock;
+
+private:
+    std::vector<ImuSample> _ring;
+    size_t _ringHead;
+    size_t _ringCount;
+
+    std::vector<long long> _pending;
+    size_t _pendingHead;
+    size_t _pendingCount;
+
+    std::vector<ImuSample> _blockSamples;
+    long long _lastFrameStamp;
+    bool _truncated;
+
+    const ImuSample& sampleAt(size_t i) const;
+    void emitOldestPending();
+};
+
+/**
+ * Largest encoded size of a block with the given number of samples.
+ */
+size_t maxEncodedImuFrameBlockSize(size_t count);
+
+/**
+ * Encodes a block as a compact little endian binary record:
+ *   uint32 record length in bytes, including this field
+ *   int64  frame timestamp in nanoseconds
+ *   uint16 sample count
+ *   uint8  ImuBlockFlags
+ *   the interpolated sample, then count samples, each as
+ *     int32  sample timestamp minus frame timestamp, in microseconds
+ *     uint8  ImuFields
+ *     float[3] for each group present, in the order euler, gyro, accel, mag
+ * Returns the number of bytes written, or 0 if capacity is too small.
+ */
+size_t encodeImuFrameBlock(const ImuFrameBlock& block, char *out, size_t capacity);
+
+#endif /* IMUFRAMEALIGNER_H_ */
@@ -0,0 +1,29 @@
+/*
+ * ImuLineListener.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ImuLineListener.h"
+
+ImuLineListener::ImuLineListener(clockid_t clock)
+    : LhandleLine(this), _clock(clock)
+{
+}
+
+void ImuLineListener::handleLine(const SerialLine& line) {
+    ImuSample sample;
+    if(parseImuLine(line.data, line.length, sample))
+    {
+        // The event thread's arrival stamp is on CLOCK_MONOTONIC
+        if(line.stamp > 0 && _clock == CLOCK_MONOTONIC)
+            sample.stamp = line.stamp;
+        else
+        {
+            timespec now;
+            clock_gettime(_clock, &now);
+            sample.stamp = toNanoseconds(now);
+        }
+        onSample(sample);
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * ImuLineListener.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef IMULINELISTENER_H_
+#define IMULINELISTENER_H_
+
+#include <time.h>
+#include <events/Event.hpp>
+#include "serial/ASIOSerialPort.h"
+#include "ImuSample.h"
+
+/**
+ * Turns the lines of the IMU serial port into timestamped samples:
+ *
+ *   ImuLineListener imuLines;
+ *   imu.onLineData += &imuLines.LhandleLine;
+ *   imuLines.onSample += &estimator.Lupdate;
+ *   imu.startEvents();
+ *
+ * Samples carry the arrival stamp of their line on CLOCK_MONOTONIC; on
+ * another clock they are stamped when handled. Lines that are not IMU
+ * lines are dropped. Does not allocate.
+ */
+class ImuLineListener {
+public:
+    ImuLineListener(clockid_t clock = CLOCK_MONOTONIC);
+
+    void handleLine(const SerialLine& line);
+    LISTENER(ImuLineListener, handleLine, const SerialLine&);
+
+    Event<const ImuSample&> onSample;
+
+private:
+    clockid_t _clock;
+};
+
+#endif /* IMULINELISTENER_H_ */
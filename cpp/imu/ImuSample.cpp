@@ -0,0 +1,122 @@
+/*
+ * ImuSample.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ImuSample.h"
+#include <math.h>
+#include <string.h>
+
+// Exponent digits stop counting past this; any float is 0 or infinite by then
+static const int kMaxExponent = 40;
+
+// Parses a decimal number like "-12.5" or "3e-2" at p, advancing p past it.
+static bool parseNumber(const char *&p, const char *end, float& value) {
+    const char *start = p;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        p++;
+    }
+    double v = 0;
+    bool digits = false;
+    while(p < end && *p >= '0' && *p <= '9')
+    {
+        v = v * 10 + (*p++ - '0');
+        digits = true;
+    }
+    if(p < end && *p == '.')
+    {
+        p++;
+        double scale = 0.1;
+        while(p < end && *p >= '0' && *p <= '9')
+        {
+            v += (*p++ - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+        }
+    }
+    if(!digits)
+    {
+        p = start;
+        return false;
+    }
+    if(p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *e = p + 1;
+        bool negExp = false;
+        if(e < end && (*e == '-' || *e == '+'))
+            negExp = (*e++ == '-');
+        if(e < end && *e >= '0' && *e <= '9')
+        {
+            int exponent = 0;
+            while(e < end && *e >= '0' && *e <= '9')
+            {
+                if(exponent <= kMaxExponent)
+                    exponent = exponent * 10 + (*e - '0');
+                e++;
+            }
+            v *= pow(10.0, negExp ? -exponent : exponent);
+            p = e;
+        }
+    }
+    value = (float)(negative ? -v : v);
+    return true;
+}
+
+// Parses up to max comma separated numbers, stopping at the first non-number.
+static int parseList(const char *&p, const char *end, float *values, int max) {
+    int n = 0;
+    while(n < max && parseNumber(p, end, values[n]))
+    {
+        n++;
+        if(p < end && *p == ',' && p + 1 < end && (p[1] == '-' || p[1] == '+' || p[1] == '.' || (p[1] >= '0' && p[1] <= '9')))
+            p++;
+        else
+            break;
+    }
+    return n;
+}
+
+static bool skipToken(const char *&p, const char *end, const char *token) {
+    size_t len = strlen(token);
+    if((size_t)(end - p) < len || memcmp(p, token, len) != 0)
+        return false;
+    p += len;
+    return true;
+}
+
+bool parseImuLine(const char *line, size_t length, ImuSample& sample) {
+    const char *p = line;
+    const char *end = line + length;
+    if(!skipToken(p, end, "!ANG:"))
+        return false;
+
+    sample.fields = 0;
+    if(parseList(p, end, sample.euler, 3) != 3)
+        return false;
+    sample.fields |= IMU_HAS_EULER;
+
+    if(!skipToken(p, end, ",AN:"))
+        return true;
+    float an[9];
+    int n = parseList(p, end, an, 9);
+    if(n >= 3)
+    {
+        memcpy(sample.gyro, an, sizeof(sample.gyro));
+        sample.fields |= IMU_HAS_GYRO;
+    }
+    if(n >= 6)
+    {
+        memcpy(sample.accel, an + 3, sizeof(sample.accel));
+        sample.fields |= IMU_HAS_ACCEL;
+    }
+    if(n >= 9)
+    {
+        memcpy(sample.mag, an + 6, sizeof(sample.mag));
+        sample.fields |= IMU_HAS_MAG;
+    }
+    return true;
+}
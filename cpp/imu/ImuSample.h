@@ -0,0 +1,50 @@
+/*
+ * ImuSample.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef IMUSAMPLE_H_
+#define IMUSAMPLE_H_
+
+#include <stddef.h>
+#include <time.h>
+
+/**
+ * Flags telling which groups of an ImuSample were present in the IMU line.
+ */
+enum ImuFields {
+    IMU_HAS_EULER = 0x01,
+    IMU_HAS_GYRO  = 0x02,
+    IMU_HAS_ACCEL = 0x04,
+    IMU_HAS_MAG   = 0x08
+};
+
+/**
+ * One parsed line of the IMU ("!ANG:roll,pitch,yaw,AN:gx,gy,gz,ax,ay,az,mx,my,mz").
+ * The AN: values are passed through in the units the IMU firmware prints them.
+ */
+struct ImuSample {
+    long long stamp;    // nanoseconds on the logging clock
+    float euler[3];     // roll, pitch, yaw in degrees
+    float gyro[3];
+    float accel[3];
+    float mag[3];
+    unsigned char fields;
+};
+
+/**
+ * Parses an IMU line of the given length (without the newline) into sample.
+ * Leaves sample.stamp untouched. Returns false if the line is not an IMU line.
+ * Does not allocate.
+ */
+bool parseImuLine(const char *line, size_t length, ImuSample& sample);
+
+/**
+ * Converts a clock_gettime() timestamp to nanoseconds.
+ */
+inline long long toNanoseconds(const timespec& t) {
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+#endif /* IMUSAMPLE_H_ */
@@ -0,0 +1,169 @@
+/*
+ * ChecksumManifest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ChecksumManifest.h"
+#include "util/Crc32c.h"
+#include <boost/bind.hpp>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+
+ChecksumManifest::ChecksumManifest()
+    : _fd(-1), _queueHead(0), _queueCount(0), _readerRunning(false)
+{
+}
+
+ChecksumManifest::~ChecksumManifest() {
+    close();
+}
+
+bool ChecksumManifest::open(const char *path) {
+    close();
+    _fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(_fd < 0)
+    {
+        std::cerr << "Failed to open checksum manifest: " << path << std::endl;
+        return false;
+    }
+    _readerRunning = true;
+    _reader = boost::thread(boost::bind(&ChecksumManifest::readerRun, this));
+    boost::mutex::scoped_lock lock(_queueLock);
+    if(!_threadPolicy.isDefault())
+        applyThreadPolicy(_reader.native_handle(), _threadPolicy, "checksum reader");
+    return true;
+}
+
+void ChecksumManifest::close() {
+    if(_fd < 0)
+        return;
+    {
+        boost::mutex::scoped_lock lock(_queueLock);
+        _readerRunning = false;
+    }
+    _fileQueued.notify_all();
+    _reader.join();
+    ::close(_fd);
+    _fd = -1;
+}
+
+void ChecksumManifest::setThreadPolicy(const ThreadPolicy& policy) {
+    boost::mutex::scoped_lock lock(_queueLock);
+    _threadPolicy = policy;
+    if(_reader.joinable())
+        applyThreadPolicy(_reader.native_handle(), policy, "checksum reader");
+}
+
+void ChecksumManifest::addRange(const char *name, unsigned long long offset, size_t length, unsigned int crc) {
+    char line[320];
+    int n = snprintf(line, sizeof(line), "%s %llu %lu %08x\n", name, offset, (unsigned long)length, crc);
+    if(n <= 0 || (size_t)n >= sizeof(line))
+        return;
+    boost::mutex::scoped_lock lock(_lock);
+    if(_fd >= 0 && ::write(_fd, line, n) != n)
+        std::cerr << "Failed to write checksum manifest: " << strerror(errno) << std::endl;
+}
+
+bool ChecksumManifest::addFile(const char *path, const char *name) {
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        std::cerr << "Failed to read back " << path << " for its checksum" << std::endl;
+        return false;
+    }
+    char buffer[kFileRangeSize];
+    unsigned long long offset = 0;
+    bool ok = true;
+    while(true)
+    {
+        size_t used = 0;
+        while(used < kFileRangeSize)
+        {
+            ssize_t n = ::read(fd, buffer + used, kFileRangeSize - used);
+            if(n < 0 && errno == EINTR)
+                continue;
+            if(n < 0)
+                ok = false;
+            if(n <= 0)
+                break;
+            used += n;
+        }
+        if(used > 0)
+            addRange(name, offset, used, crc32c(0, buffer, used));
+        offset += used;
+        if(used < kFileRangeSize)
+            break;
+    }
+    ::close(fd);
+    return ok;
+}
+
+void ChecksumManifest::queueFile(const char *path, const char *name) {
+    {
+        boost::mutex::scoped_lock lock(_queueLock);
+        if(_readerRunning && _queueCount < kQueuedFiles &&
+           strlen(path) < sizeof(_queue[0].path) && strlen(name) < sizeof(_queue[0].name))
+        {
+            QueuedFile& file = _queue[(_queueHead + _queueCount) % kQueuedFiles];
+            strcpy(file.path, path);
+            strcpy(file.name, name);
+            _queueCount++;
+            lock.unlock();
+            _fileQueued.notify_one();
+            return;
+        }
+    }
+    addFile(path, name);
+}
+
+void ChecksumManifest::readerRun() {
+    boost::mutex::scoped_lock lock(_queueLock);
+    while(true)
+    {
+        while(_readerRunning && _queueCount == 0)
+            _fileQueued.wait(lock);
+        // Files queued before close() are still read
+        if(_queueCount == 0)
+            return;
+        QueuedFile file = _queue[_queueHead];
+        _queueHead = (_queueHead + 1) % kQueuedFiles;
+        _queueCount--;
+        lock.unlock();
+        addFile(file.path, file.name);
+        lock.lock();
+    }
+}
+
+bool parseChecksumLine(const char *line, size_t length, ChecksumEntry& entry) {
+    const char *end = line + length;
+    const char *space = (const char *)memchr(line, ' ', length);
+    if(!space || space == line)
+        return false;
+    entry.name.assign(line, space - line);
+
+    // Numbers are parsed from a terminated copy of the rest of the line
+    char rest[64];
+    size_t restLength = end - space - 1;
+    if(restLength >= sizeof(rest))
+        return false;
+    memcpy(rest, space + 1, restLength);
+    rest[restLength] = '\0';
+    char *p = rest, *q;
+    entry.offset = strtoull(p, &q, 10);
+    if(q == p || *q != ' ')
+        return false;
+    p = q + 1;
+    unsigned long rangeLength = strtoul(p, &q, 10);
+    if(q == p || *q != ' ')
+        return false;
+    entry.length = (unsigned int)rangeLength;
+    p = q + 1;
+    entry.crc = (unsigned int)strtoul(p, &q, 16);
+    return q - p == 8 && *q == '\0';
+}
@@ -0,0 +1,99 @@
+/*
+ * ChecksumManifest.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CHECKSUMMANIFEST_H_
+#define CHECKSUMMANIFEST_H_
+
+#include <stddef.h>
+#include <string>
+#include <boost/thread.hpp>
+#include "util/RealTime.h"
+
+/**
+ * One line of a manifest: the CRC-32C of length bytes of a file of the log
+ * directory, starting at offset.
+ */
+struct ChecksumEntry {
+    std::string name;
+    unsigned long long offset;
+    unsigned int length;
+    unsigned int crc;
+};
+
+/**
+ * checksums.txt of a log directory, one range per line:
+ *   <file name> <offset> <length> <crc32c as 8 hex digits>
+ * log.txt gets a line per block written by LogWriter, frame_imu.bin a line
+ * per frame, and every image or feature file is read back once written and
+ * covered in kFileRangeSize pieces, so a check can tell where a file went
+ * bad. Lines go out with a single write() each, so what reached the card
+ * before a brown-out is described. Safe to use from several threads.
+ *
+ * Files passed to queueFile() are read back by a thread started in open(),
+ * so a capture loop does not wait for its own images to come off the card.
+ */
+class ChecksumManifest {
+public:
+    static const size_t kFileRangeSize = 65536;
+    static const int kQueuedFiles = 8;
+
+    ChecksumManifest();
+    ~ChecksumManifest();
+
+    bool open(const char *path);
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+
+    /**
+     * Records the checksum of a range. Does not allocate.
+     */
+    void addRange(const char *name, unsigned long long offset, size_t length, unsigned int crc);
+
+    /**
+     * Reads the file at path and records it under name. Does not allocate.
+     */
+    bool addFile(const char *path, const char *name);
+
+    /**
+     * Like addFile(), but the file is read on the manifest's thread. When
+     * kQueuedFiles are already waiting it is read here instead. Does not
+     * allocate. close() waits for the queued files.
+     */
+    void queueFile(const char *path, const char *name);
+
+    /**
+     * Scheduling for the thread reading queued files. Applied now if the
+     * manifest is open and to the thread of every later open().
+     */
+    void setThreadPolicy(const ThreadPolicy& policy);
+
+private:
+    struct QueuedFile {
+        char path[256];
+        char name[64];
+    };
+
+    int _fd;
+    boost::mutex _lock;
+
+    QueuedFile _queue[kQueuedFiles];
+    int _queueHead;
+    int _queueCount;
+    bool _readerRunning;
+    boost::mutex _queueLock;
+    boost::condition_variable _fileQueued;
+    boost::thread _reader;
+    ThreadPolicy _threadPolicy;
+
+    void readerRun();
+};
+
+/**
+ * Parses a manifest line (without the newline). Returns false if it is malformed.
+ */
+bool parseChecksumLine(const char *line, size_t length, ChecksumEntry& entry);
+
+#endif /* CHECKSUMMANIFEST_H_ */
@@ -0,0 +1,333 @@
+/*
+ * ColumnFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ColumnFile.h"
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+static const char kMagic[4] = { 'B', 'B', 'C', 'F' };
+static const unsigned int kVersion = 2;
+static const size_t kHeaderSize = 56;
+// Stored in host byte order; reads back as itself only on a host of the same order
+static const unsigned int kByteOrderMark = 0x01020304;
+static const unsigned int kSwappedByteOrderMark = 0x04030201;
+static const size_t kColumnEntrySize = 32;
+static const size_t kColumnNameLength = 24;
+static const size_t kChunkHeaderSize = 8;
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+// Integers are in host byte order, like the column values the reader hands out in place
+static void put32(char *p, unsigned int v) { memcpy(p, &v, 4); }
+static void put64(char *p, unsigned long long v) { memcpy(p, &v, 8); }
+static unsigned int get32(const char *p) { unsigned int v; memcpy(&v, p, 4); return v; }
+static unsigned long long get64(const char *p) { unsigned long long v; memcpy(&v, p, 8); return v; }
+
+static bool pwriteAll(int fd, const char *data, size_t length, off_t offset) {
+    while(length > 0)
+    {
+        ssize_t n = pwrite(fd, data, length, offset);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+        data += n;
+        length -= n;
+        offset += n;
+    }
+    return true;
+}
+
+size_t columnTypeSize(ColumnType type) {
+    switch(type)
+    {
+    case COLUMN_INT64:   return 8;
+    case COLUMN_FLOAT64: return 8;
+    case COLUMN_FLOAT32: return 4;
+    case COLUMN_UINT8:   return 1;
+    }
+    return 0;
+}
+
+/* ************************************************************************* */
+ColumnBatch::ColumnBatch(const ColumnSpec *specs, int columnCount)
+    : _specs(specs, specs + columnCount), _columns(columnCount)
+{
+}
+
+size_t ColumnBatch::rows() const {
+    if(_columns.empty())
+        return 0;
+    return _columns[0].size() / columnTypeSize(_specs[0].type);
+}
+
+void ColumnBatch::clear() {
+    for(size_t c = 0; c < _columns.size(); c++)
+        _columns[c].clear();
+}
+
+/* ************************************************************************* */
+ColumnFileWriter::ColumnFileWriter()
+    : _fd(-1), _rowsPerChunk(0), _chunkSize(0), _dataOffset(0),
+      _chunkRows(0), _chunks(0), _rows(0), _ok(false)
+{
+}
+
+ColumnFileWriter::~ColumnFileWriter() {
+    close();
+}
+
+bool ColumnFileWriter::open(const std::string& path, const ColumnSpec *specs, int columnCount,
+                            unsigned int rowsPerChunk) {
+    close();
+    _specs.assign(specs, specs + columnCount);
+    _rowsPerChunk = rowsPerChunk;
+
+    // Chunk layout: header, min/max of every column, then the columns
+    size_t offset = kChunkHeaderSize + 2 * sizeof(ColumnBound) * columnCount;
+    _columnOffsets.resize(columnCount);
+    for(int c = 0; c < columnCount; c++)
+    {
+        _columnOffsets[c] = offset;
+        offset = align8(offset + rowsPerChunk * columnTypeSize(specs[c].type));
+    }
+    _chunkSize = offset;
+    _dataOffset = align8(kHeaderSize + kColumnEntrySize * columnCount);
+    _chunk.assign(_chunkSize, 0);
+    _chunkRows = 0;
+    _chunks = 0;
+    _rows = 0;
+
+    _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(_fd < 0)
+    {
+        std::cerr << "Failed to open column file: " << path << std::endl;
+        return false;
+    }
+    _ok = writeHeader();
+    return _ok;
+}
+
+bool ColumnFileWriter::writeHeader() {
+    std::vector<char> header(_dataOffset, 0);
+    memcpy(&header[0], kMagic, 4);
+    put32(&header[4], kVersion);
+    put32(&header[8], (unsigned int)_specs.size());
+    put32(&header[12], _rowsPerChunk);
+    put64(&header[16], _chunks);
+    put64(&header[24], _rows);
+    put64(&header[32], _chunkSize);
+    put64(&header[40], _dataOffset);
+    put32(&header[48], kByteOrderMark);
+    for(size_t c = 0; c < _specs.size(); c++)
+    {
+        char *entry = &header[kHeaderSize + c * kColumnEntrySize];
+        strncpy(entry, _specs[c].name, kColumnNameLength - 1);
+        put32(entry + kColumnNameLength, _specs[c].type);
+        put32(entry + kColumnNameLength + 4, (unsigned int)_columnOffsets[c]);
+    }
+    return pwriteAll(_fd, &header[0], header.size(), 0);
+}
+
+bool ColumnFileWriter::append(const ColumnBatch& batch) {
+    if(_fd < 0 || batch.columnCount() != (int)_specs.size())
+        return false;
+    size_t rows = batch.rows();
+    size_t done = 0;
+    while(done < rows)
+    {
+        size_t n = std::min(rows - done, (size_t)(_rowsPerChunk - _chunkRows));
+        for(size_t c = 0; c < _specs.size(); c++)
+        {
+            size_t width = columnTypeSize(_specs[c].type);
+            memcpy(&_chunk[_columnOffsets[c] + _chunkRows * width], batch.column(c) + done * width, n * width);
+        }
+        _chunkRows += n;
+        done += n;
+        if(_chunkRows == _rowsPerChunk && !flushChunk())
+            return false;
+    }
+    return _ok;
+}
+
+template <typename T>
+static void integerBounds(const char *values, unsigned int rows, ColumnBound& min, ColumnBound& max) {
+    min.i = 0;
+    max.i = -1;
+    for(unsigned int r = 0; r < rows; r++)
+    {
+        T v;
+        memcpy(&v, values + r * sizeof(T), sizeof(T));
+        if(r == 0 || v < min.i)
+            min.i = v;
+        if(r == 0 || v > max.i)
+            max.i = v;
+    }
+}
+
+template <typename T>
+static void floatBounds(const char *values, unsigned int rows, ColumnBound& min, ColumnBound& max) {
+    min.f = INFINITY;
+    max.f = -INFINITY;
+    for(unsigned int r = 0; r < rows; r++)
+    {
+        T v;
+        memcpy(&v, values + r * sizeof(T), sizeof(T));
+        if(v != v)
+            continue;
+        if(v < min.f)
+            min.f = v;
+        if(v > max.f)
+            max.f = v;
+    }
+}
+
+bool ColumnFileWriter::flushChunk() {
+    if(_chunkRows == 0)
+        return true;
+    put32(&_chunk[0], _chunkRows);
+    put32(&_chunk[4], 0);
+    for(size_t c = 0; c < _specs.size(); c++)
+    {
+        // Clear what the previous chunk left behind the last row
+        size_t width = columnTypeSize(_specs[c].type);
+        memset(&_chunk[_columnOffsets[c] + _chunkRows * width], 0, (_rowsPerChunk - _chunkRows) * width);
+
+        const char *values = &_chunk[_columnOffsets[c]];
+        ColumnBound min, max;
+        switch(_specs[c].type)
+        {
+        case COLUMN_INT64:   integerBounds<long long>(values, _chunkRows, min, max); break;
+        case COLUMN_UINT8:   integerBounds<unsigned char>(values, _chunkRows, min, max); break;
+        case COLUMN_FLOAT64: floatBounds<double>(values, _chunkRows, min, max); break;
+        case COLUMN_FLOAT32: floatBounds<float>(values, _chunkRows, min, max); break;
+        }
+        memcpy(&_chunk[kChunkHeaderSize + 2 * c * sizeof(ColumnBound)], &min, sizeof(min));
+        memcpy(&_chunk[kChunkHeaderSize + (2 * c + 1) * sizeof(ColumnBound)], &max, sizeof(max));
+    }
+    if(!pwriteAll(_fd, &_chunk[0], _chunkSize, _dataOffset + _chunks * _chunkSize))
+    {
+        std::cerr << "Failed to write column file: " << strerror(errno) << std::endl;
+        _ok = false;
+        return false;
+    }
+    _chunks++;
+    _rows += _chunkRows;
+    _chunkRows = 0;
+    return true;
+}
+
+bool ColumnFileWriter::close() {
+    if(_fd < 0)
+        return _ok;
+    bool ok = _ok && flushChunk() && writeHeader();
+    ::close(_fd);
+    _fd = -1;
+    _ok = false;
+    return ok;
+}
+
+/* ************************************************************************* */
+ColumnFileReader::ColumnFileReader()
+    : _map(0), _mapLength(0), _rowsPerChunk(0), _chunks(0), _rows(0), _chunkSize(0), _dataOffset(0)
+{
+}
+
+ColumnFileReader::~ColumnFileReader() {
+    close();
+}
+
+bool ColumnFileReader::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < kHeaderSize)
+    {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED)
+        return false;
+    _map = (const char *)map;
+    _mapLength = st.st_size;
+
+    unsigned int columns = get32(_map + 8);
+    _rowsPerChunk = get32(_map + 12);
+    _chunks = get64(_map + 16);
+    _rows = get64(_map + 24);
+    _chunkSize = get64(_map + 32);
+    _dataOffset = get64(_map + 40);
+    if(memcmp(_map, kMagic, 4) == 0 && get32(_map + 48) == kSwappedByteOrderMark)
+        std::cerr << "Column file " << path << " was written on a host of the other byte order" << std::endl;
+    if(memcmp(_map, kMagic, 4) != 0 || get32(_map + 4) != kVersion || get32(_map + 48) != kByteOrderMark ||
+       _dataOffset < kHeaderSize + kColumnEntrySize * columns ||
+       _dataOffset + _chunks * _chunkSize > _mapLength)
+    {
+        close();
+        return false;
+    }
+    for(unsigned int c = 0; c < columns; c++)
+    {
+        const char *entry = _map + kHeaderSize + c * kColumnEntrySize;
+        _names.push_back(std::string(entry, strnlen(entry, kColumnNameLength)));
+        _types.push_back((ColumnType)get32(entry + kColumnNameLength));
+        _columnOffsets.push_back(get32(entry + kColumnNameLength + 4));
+    }
+    return true;
+}
+
+void ColumnFileReader::close() {
+    if(_map)
+        munmap((void *)_map, _mapLength);
+    _map = 0;
+    _mapLength = 0;
+    _names.clear();
+    _types.clear();
+    _columnOffsets.clear();
+    _chunks = 0;
+    _rows = 0;
+}
+
+int ColumnFileReader::findColumn(const char *name) const {
+    for(size_t c = 0; c < _names.size(); c++)
+        if(_names[c] == name)
+            return (int)c;
+    return -1;
+}
+
+unsigned int ColumnFileReader::chunkRows(unsigned long long i) const {
+    return get32(chunk(i));
+}
+
+ColumnBound ColumnFileReader::chunkMin(unsigned long long i, int c) const {
+    ColumnBound b;
+    memcpy(&b, chunk(i) + kChunkHeaderSize + 2 * c * sizeof(ColumnBound), sizeof(b));
+    return b;
+}
+
+ColumnBound ColumnFileReader::chunkMax(unsigned long long i, int c) const {
+    ColumnBound b;
+    memcpy(&b, chunk(i) + kChunkHeaderSize + (2 * c + 1) * sizeof(ColumnBound), sizeof(b));
+    return b;
+}
+
+const void *ColumnFileReader::chunkColumn(unsigned long long i, int c) const {
+    return chunk(i) + _columnOffsets[c];
+}
@@ -0,0 +1,164 @@
+/*
+ * ColumnFile.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef COLUMNFILE_H_
+#define COLUMNFILE_H_
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/**
+ * Column types of a column file; every value has a fixed width.
+ */
+enum ColumnType {
+    COLUMN_INT64,
+    COLUMN_FLOAT64,
+    COLUMN_FLOAT32,
+    COLUMN_UINT8
+};
+
+size_t columnTypeSize(ColumnType type);
+
+struct ColumnSpec {
+    const char *name;
+    ColumnType type;
+};
+
+/**
+ * Rows of a table held column by column while they are being built.
+ * Values are pushed column by column, in column order, one row at a time.
+ */
+class ColumnBatch {
+public:
+    ColumnBatch(const ColumnSpec *specs, int columnCount);
+
+    template <typename T>
+    void push(int column, T value) {
+        std::vector<char>& data = _columns[column];
+        size_t size = data.size();
+        data.resize(size + sizeof(T));
+        memcpy(&data[size], &value, sizeof(T));
+    }
+
+    size_t rows() const;
+    int columnCount() const { return (int)_columns.size(); }
+    const char *column(int c) const { return _columns[c].empty() ? 0 : &_columns[c][0]; }
+    void clear();
+
+private:
+    std::vector<ColumnSpec> _specs;
+    std::vector<std::vector<char> > _columns;
+};
+
+/**
+ * Smallest and largest value of a column in a chunk. Integer columns use
+ * the integer member, float columns the float one; NaNs are left out, and
+ * a chunk where every value is NaN has min > max.
+ */
+union ColumnBound {
+    long long i;
+    double f;
+};
+
+/**
+ * Column file layout (host byte order, everything 8 byte aligned):
+ *   header   "BBCF", uint32 version, uint32 column count, uint32 rows per
+ *            chunk, uint64 chunk count, uint64 row count, uint64 chunk
+ *            size, uint64 offset of the first chunk, uint32 byte order
+ *            mark 0x01020304, uint32 reserved
+ *   columns  per column: char[24] name, uint32 ColumnType, uint32 offset
+ *            of the column inside a chunk
+ *   chunks   all chunk size bytes, so chunk i starts at first + i * size:
+ *              uint32 rows in this chunk, uint32 reserved,
+ *              per column: ColumnBound min, ColumnBound max
+ *              per column: rows per chunk values (only rows are valid)
+ * Only the last chunk may be partly filled. Values stay in host order so a
+ * reader can hand them out straight from the mapped file; the byte order
+ * mark makes a reader on a host of the other order refuse the file instead
+ * of misreading it.
+ */
+class ColumnFileWriter {
+public:
+    ColumnFileWriter();
+    ~ColumnFileWriter();
+
+    bool open(const std::string& path, const ColumnSpec *specs, int columnCount,
+              unsigned int rowsPerChunk = 65536);
+
+    /**
+     * Appends the rows of batch, whose columns must match the file's.
+     */
+    bool append(const ColumnBatch& batch);
+
+    /**
+     * Writes out the last chunk and the final header.
+     */
+    bool close();
+
+    unsigned long long rows() const { return _rows; }
+
+private:
+    int _fd;
+    std::vector<ColumnSpec> _specs;
+    std::vector<size_t> _columnOffsets;
+    unsigned int _rowsPerChunk;
+    size_t _chunkSize;
+    size_t _dataOffset;
+    std::vector<char> _chunk;
+    unsigned int _chunkRows;
+    unsigned long long _chunks;
+    unsigned long long _rows;
+    bool _ok;
+
+    bool flushChunk();
+    bool writeHeader();
+};
+
+/**
+ * Memory mapped, read-only view of a column file.
+ */
+class ColumnFileReader {
+public:
+    ColumnFileReader();
+    ~ColumnFileReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    int columnCount() const { return (int)_names.size(); }
+    const std::string& columnName(int c) const { return _names[c]; }
+    ColumnType columnType(int c) const { return _types[c]; }
+    int findColumn(const char *name) const;
+
+    unsigned long long rows() const { return _rows; }
+    unsigned long long chunkCount() const { return _chunks; }
+    unsigned int chunkRows(unsigned long long chunk) const;
+    ColumnBound chunkMin(unsigned long long chunk, int c) const;
+    ColumnBound chunkMax(unsigned long long chunk, int c) const;
+
+    /**
+     * Values of column c in the chunk, chunkRows(chunk) of columnType(c).
+     */
+    const void *chunkColumn(unsigned long long chunk, int c) const;
+
+private:
+    const char *_map;
+    size_t _mapLength;
+    std::vector<std::string> _names;
+    std::vector<ColumnType> _types;
+    std::vector<size_t> _columnOffsets;
+    unsigned int _rowsPerChunk;
+    unsigned long long _chunks;
+    unsigned long long _rows;
+    size_t _chunkSize;
+    size_t _dataOffset;
+
+    const char *chunk(unsigned long long i) const { return _map + _dataOffset + i * _chunkSize; }
+};
+
+#endif /* COLUMNFILE_H_ */
@@ -0,0 +1,155 @@
+/*
+ * LogIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "LogIndex.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+static const unsigned int kIndexVersion = 1;
+static const size_t kHeaderSize = 8;
+static const size_t kEntrySize = 16;
+
+// Fields are stored byte by byte, so files move between hosts of either byte order
+static char *putLe(char *out, unsigned long long value, size_t size) {
+    for(size_t i = 0; i < size; i++)
+        *out++ = (char)(value >> (8 * i));
+    return out;
+}
+
+static unsigned long long getLe(const char *in, size_t size) {
+    unsigned long long value = 0;
+    for(size_t i = 0; i < size; i++)
+        value |= (unsigned long long)(unsigned char)in[i] << (8 * i);
+    return value;
+}
+
+TimeIndexWriter::TimeIndexWriter()
+    : _fd(-1), _last(0), _count(0)
+{
+}
+
+TimeIndexWriter::~TimeIndexWriter() {
+    close();
+}
+
+bool TimeIndexWriter::open(const char *path, const char magic[4]) {
+    close();
+    _fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(_fd < 0)
+    {
+        std::cerr << "Failed to open index: " << path << std::endl;
+        return false;
+    }
+    char header[kHeaderSize];
+    memcpy(header, magic, 4);
+    putLe(header + 4, kIndexVersion, 4);
+    if(::write(_fd, header, kHeaderSize) != (ssize_t)kHeaderSize)
+    {
+        std::cerr << "Failed to write index: " << path << std::endl;
+        close();
+        return false;
+    }
+    _count = 0;
+    return true;
+}
+
+void TimeIndexWriter::close() {
+    if(_fd < 0)
+        return;
+    ::close(_fd);
+    _fd = -1;
+}
+
+void TimeIndexWriter::add(long long stamp, unsigned long long offset) {
+    if(_fd < 0 || (_count > 0 && stamp < _last))
+        return;
+    char entry[kEntrySize];
+    putLe(putLe(entry, (unsigned long long)stamp, 8), offset, 8);
+    if(::write(_fd, entry, kEntrySize) != (ssize_t)kEntrySize)
+    {
+        std::cerr << "Failed to write index: " << strerror(errno) << std::endl;
+        return;
+    }
+    _last = stamp;
+    _count++;
+}
+
+TimeIndexReader::TimeIndexReader()
+    : _map(0), _mapLength(0), _count(0)
+{
+}
+
+TimeIndexReader::~TimeIndexReader() {
+    close();
+}
+
+bool TimeIndexReader::open(const char *path, const char magic[4]) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < kHeaderSize)
+    {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED)
+        return false;
+    _map = (const char *)map;
+    _mapLength = st.st_size;
+
+    unsigned int version = (unsigned int)getLe(_map + 4, 4);
+    if(memcmp(_map, magic, 4) != 0 || version != kIndexVersion)
+    {
+        close();
+        return false;
+    }
+    _count = (_mapLength - kHeaderSize) / kEntrySize;
+    return true;
+}
+
+void TimeIndexReader::close() {
+    if(_map)
+        munmap((void *)_map, _mapLength);
+    _map = 0;
+    _mapLength = 0;
+    _count = 0;
+}
+
+TimeIndexEntry TimeIndexReader::entry(size_t i) const {
+    TimeIndexEntry e;
+    const char *p = _map + kHeaderSize + i * kEntrySize;
+    e.stamp = (long long)getLe(p, 8);
+    e.offset = getLe(p + 8, 8);
+    return e;
+}
+
+size_t TimeIndexReader::upperBound(long long stamp) const {
+    size_t low = 0, high = _count;
+    while(low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if(entry(mid).stamp <= stamp)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+void frameBaseName(long long stamp, char *name, size_t capacity) {
+    snprintf(name, capacity, "Image-%lld-%.9ld",
+             stamp / 1000000000LL, (long)(stamp % 1000000000LL));
+}
@@ -0,0 +1,93 @@
+/*
+ * LogIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LOGINDEX_H_
+#define LOGINDEX_H_
+
+#include <stddef.h>
+
+/**
+ * Sparse time index files written next to the log:
+ *   log.idx    : one point per indexInterval of log time, the timestamp of a
+ *                log.txt record and the byte offset where that record starts
+ *   frames.idx : one point per captured frame, its timestamp and the size of
+ *                log.txt at that moment
+ * Both are an 8 byte header (4 byte magic, uint32 version) followed by
+ * little endian entries of
+ *   int64  timestamp in nanoseconds, on the clock of the log records
+ *   uint64 byte offset into log.txt
+ * Timestamps never decrease within a file, so a reader can binary search
+ * the mapped file directly. A crash can leave a partial last entry, which
+ * readers ignore.
+ */
+struct TimeIndexEntry {
+    long long stamp;
+    unsigned long long offset;
+};
+
+static const char kLogIndexMagic[4] = { 'B', 'B', 'L', 'I' };
+static const char kFrameIndexMagic[4] = { 'B', 'B', 'F', 'I' };
+
+/**
+ * Appends entries to an index file. Each entry is one write() so the file
+ * stays usable when the logger dies; entries that would go back in time are
+ * dropped.
+ */
+class TimeIndexWriter {
+public:
+    TimeIndexWriter();
+    ~TimeIndexWriter();
+
+    bool open(const char *path, const char magic[4]);
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+
+    void add(long long stamp, unsigned long long offset);
+
+    unsigned long long count() const { return _count; }
+
+private:
+    int _fd;
+    long long _last;
+    unsigned long long _count;
+};
+
+/**
+ * Read-only view of a memory mapped index file.
+ */
+class TimeIndexReader {
+public:
+    TimeIndexReader();
+    ~TimeIndexReader();
+
+    /**
+     * Maps the file and checks its header. Returns false if it is missing
+     * or not an index of the expected kind.
+     */
+    bool open(const char *path, const char magic[4]);
+    void close();
+
+    size_t size() const { return _count; }
+    TimeIndexEntry entry(size_t i) const;
+
+    /**
+     * Index of the first entry with a timestamp above stamp (size() if none),
+     * in O(log n).
+     */
+    size_t upperBound(long long stamp) const;
+
+private:
+    const char *_map;
+    size_t _mapLength;
+    size_t _count;
+};
+
+/**
+ * File name (without extension) bbLog gives the frame captured at stamp.
+ */
+void frameBaseName(long long stamp, char *name, size_t capacity);
+
+#endif /* LOGINDEX_H_ */
@@ -0,0 +1,346 @@
+/*
+ * LogWriter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "LogWriter.h"
+#include "LogIndex.h"
+#include "ChecksumManifest.h"
+#include "util/Crc32c.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+
+// Room for the tag, the timestamp fields, the UTC field, separators and newline
+static const size_t kMaxRecordOverhead = 96;
+// %g of a float never needs more than this
+static const size_t kMaxValueLength = 16;
+
+static char *appendInteger(char *p, long long v) {
+    char digits[24];
+    int n = 0;
+    bool negative = v < 0;
+    unsigned long long u = negative ? -(unsigned long long)v : (unsigned long long)v;
+    do {
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while(u);
+    if(negative)
+        *p++ = '-';
+    while(n)
+        *p++ = digits[--n];
+    return p;
+}
+
+// Nine digits with leading zeros, for the nanoseconds of a UTC field
+static char *appendNanoseconds(char *p, long long v) {
+    for(int i = 8; i >= 0; i--)
+    {
+        p[i] = (char)('0' + v % 10);
+        v /= 10;
+    }
+    return p + 9;
+}
+
+static long long millisecondsBetween(const timespec& start, const timespec& end) {
+    return (end.tv_sec - start.tv_sec) * 1000LL + (end.tv_nsec - start.tv_nsec) / 1000000;
+}
+
+static bool writeAll(int fd, const char *data, size_t length) {
+    while(length > 0)
+    {
+        ssize_t n = ::write(fd, data, length);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+LogWriter::LogWriter(size_t blockSize, int maxDelayMs)
+    : _fd(-1), _current(0), _used(0), _maxDelayMs(maxDelayMs), _flushed(0),
+      _pendingUsed(0), _pendingOffset(0),
+      _index(0), _indexInterval(0), _nextIndexStamp(0), _checksums(0), _checksumName(0),
+      _flusherRunning(false)
+{
+    _blocks[0].resize(blockSize);
+    _blocks[1].resize(blockSize);
+    _oldest.tv_sec = 0;
+    _oldest.tv_nsec = 0;
+}
+
+LogWriter::~LogWriter() {
+    close();
+}
+
+bool LogWriter::open(const char *path) {
+    close();
+    _fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(_fd < 0)
+    {
+        std::cerr << "Failed to open log: " << path << std::endl;
+        return false;
+    }
+    _flushed = 0;
+    _flusherRunning = true;
+    _flusher = boost::thread(boost::bind(&LogWriter::flusherRun, this));
+    boost::mutex::scoped_lock lock(_lock);
+    if(!_threadPolicy.isDefault())
+        applyThreadPolicy(_flusher.native_handle(), _threadPolicy, "log writer");
+    return true;
+}
+
+void LogWriter::close() {
+    {
+        boost::mutex::scoped_lock lock(_lock);
+        handOver(lock);
+        _flusherRunning = false;
+        _wakeFlusher.notify_one();
+    }
+    // The flusher writes out the last block before it stops
+    if(_flusher.joinable())
+        _flusher.join();
+
+    boost::mutex::scoped_lock lock(_lock);
+    if(_fd < 0)
+        return;
+    ::close(_fd);
+    _fd = -1;
+}
+
+void LogWriter::setThreadPolicy(const ThreadPolicy& policy) {
+    boost::mutex::scoped_lock lock(_lock);
+    _threadPolicy = policy;
+    if(_flusher.joinable())
+        applyThreadPolicy(_flusher.native_handle(), policy, "log writer");
+}
+
+void LogWriter::flusherRun() {
+    boost::mutex::scoped_lock lock(_lock);
+    while(_flusherRunning || _pendingUsed > 0)
+    {
+        if(_pendingUsed > 0)
+        {
+            // Records go on into the current block while this one is written
+            const char *data = &_blocks[_current ^ 1][0];
+            size_t length = _pendingUsed;
+            unsigned long long offset = _pendingOffset;
+            ChecksumManifest *checksums = _checksums;
+            const char *checksumName = _checksumName;
+            lock.unlock();
+            if(!writeAll(_fd, data, length))
+                std::cerr << "Failed to write log: " << strerror(errno) << std::endl;
+            else if(checksums)
+                checksums->addRange(checksumName, offset, length, crc32c(0, data, length));
+            lock.lock();
+            _pendingUsed = 0;
+            _blockWritten.notify_all();
+            continue;
+        }
+        if(_used == 0)
+        {
+            _wakeFlusher.wait(lock);
+            continue;
+        }
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long waitMs = _maxDelayMs - millisecondsBetween(_oldest, now);
+        // The block may be handed over and a new one started while waiting,
+        // so the age is looked at again after every wake up
+        if(waitMs > 0)
+            _wakeFlusher.timed_wait(lock, boost::posix_time::milliseconds(waitMs));
+        else
+            handOver(lock);
+    }
+}
+
+unsigned long long LogWriter::size() const {
+    boost::mutex::scoped_lock lock(_lock);
+    return _flushed + _used;
+}
+
+void LogWriter::setIndex(TimeIndexWriter *index, int intervalMs) {
+    boost::mutex::scoped_lock lock(_lock);
+    _index = index;
+    _indexInterval = intervalMs * 1000000LL;
+    _nextIndexStamp = 0;
+}
+
+void LogWriter::setChecksums(ChecksumManifest *manifest, const char *name) {
+    boost::mutex::scoped_lock lock(_lock);
+    _checksums = manifest;
+    _checksumName = name;
+}
+
+void LogWriter::flush() {
+    boost::mutex::scoped_lock lock(_lock);
+    handOver(lock);
+    while(_pendingUsed > 0)
+        _blockWritten.wait(lock);
+}
+
+// Gives the current block to the flusher and switches to the other one,
+// waiting first if that one is still being written. Records appended
+// before open() have nowhere to go and are dropped.
+void LogWriter::handOver(boost::mutex::scoped_lock& lock) {
+    while(_pendingUsed > 0)
+        _blockWritten.wait(lock);
+    if(_used == 0)
+        return;
+    if(_fd < 0)
+    {
+        _used = 0;
+        return;
+    }
+    _pendingUsed = _used;
+    _pendingOffset = _flushed;
+    _flushed += _used;
+    _used = 0;
+    _current ^= 1;
+    _wakeFlusher.notify_one();
+}
+
+char *LogWriter::beginRecord(boost::mutex::scoped_lock& lock, const char *tag, const timespec& stamp,
+                             size_t payloadLength) {
+    size_t needed = strlen(tag) + payloadLength + kMaxRecordOverhead;
+    if(needed > _blocks[0].size())
+        return 0;
+    // Another thread can fill the new block while this one waits in handOver()
+    while(_used + needed > _blocks[_current].size())
+        handOver(lock);
+    if(_used == 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &_oldest);
+        _wakeFlusher.notify_one();
+    }
+
+    long long stampNs = stamp.tv_sec * 1000000000LL + stamp.tv_nsec;
+    if(_index && stampNs >= _nextIndexStamp)
+    {
+        _index->add(stampNs, _flushed + _used);
+        _nextIndexStamp = stampNs + _indexInterval;
+    }
+
+    char *p = &_blocks[_current][_used];
+    size_t tagLength = strlen(tag);
+    memcpy(p, tag, tagLength);
+    p += tagLength;
+    *p++ = ' ';
+    p = appendInteger(p, stamp.tv_sec);
+    *p++ = ' ';
+    p = appendInteger(p, stamp.tv_nsec);
+    return p;
+}
+
+void LogWriter::endRecord(boost::mutex::scoped_lock& lock, char *end) {
+    *end++ = '\n';
+    _used = end - &_blocks[_current][0];
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    // With a block still being written the flusher hands this one over next
+    if(_pendingUsed == 0 && millisecondsBetween(_oldest, now) >= _maxDelayMs)
+        handOver(lock);
+}
+
+void LogWriter::write(const char *tag, const timespec& stamp, const char *text, size_t length) {
+    write(tag, stamp, -1, text, length);
+}
+
+void LogWriter::write(const char *tag, const timespec& stamp, long long utc, const char *text, size_t length) {
+    boost::mutex::scoped_lock lock(_lock);
+    char *p = beginRecord(lock, tag, stamp, length);
+    if(!p)
+    {
+        std::cerr << "Log record too long, dropped " << tag << std::endl;
+        return;
+    }
+    if(utc >= 0)
+    {
+        *p++ = ' ';
+        *p++ = '@';
+        p = appendInteger(p, utc / 1000000000LL);
+        *p++ = '.';
+        p = appendNanoseconds(p, utc % 1000000000LL);
+    }
+    *p++ = ' ';
+    memcpy(p, text, length);
+    endRecord(lock, p + length);
+}
+
+void LogWriter::writeValues(const char *tag, const timespec& stamp, const float *values, int count) {
+    boost::mutex::scoped_lock lock(_lock);
+    char *p = beginRecord(lock, tag, stamp, count * (kMaxValueLength + 1));
+    if(!p)
+    {
+        std::cerr << "Log record too long, dropped " << tag << std::endl;
+        return;
+    }
+    for(int i = 0; i < count; i++)
+    {
+        *p++ = ' ';
+        int n = snprintf(p, kMaxValueLength, "%g", values[i]);
+        p += (n > 0 && (size_t)n < kMaxValueLength) ? n : 0;
+    }
+    endRecord(lock, p);
+}
+
+static bool parseDigits(const char *&p, const char *end, long long& value) {
+    const char *begin = p;
+    bool negative = p < end && *p == '-';
+    if(negative)
+        begin = ++p;
+    value = 0;
+    while(p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    if(negative)
+        value = -value;
+    return p > begin;
+}
+
+bool parseLogRecord(const char *line, size_t length, LogRecord& record) {
+    const char *end = line + length;
+    const char *p = (const char *)memchr(line, ' ', length);
+    if(!p || p == line)
+        return false;
+    record.tag = line;
+    record.tagLength = p - line;
+    long long sec, nsec;
+    p++;
+    if(!parseDigits(p, end, sec) || p >= end || *p++ != ' ' || !parseDigits(p, end, nsec))
+        return false;
+    record.stamp = sec * 1000000000LL + nsec;
+    if(p < end && *p == ' ')
+        p++;
+    // Optional "@<sec>.<nsec>" UTC field
+    record.utc = -1;
+    if(p < end && *p == '@')
+    {
+        const char *q = p + 1;
+        long long utcSec;
+        if(parseDigits(q, end, utcSec) && end - q >= 10 && *q == '.')
+        {
+            const char *digits = ++q;
+            long long utcNsec;
+            if(parseDigits(q, end, utcNsec) && q - digits == 9 && utcSec >= 0)
+            {
+                record.utc = utcSec * 1000000000LL + utcNsec;
+                p = q;
+                if(p < end && *p == ' ')
+                    p++;
+            }
+        }
+    }
+    record.text = p;
+    record.textLength = end - p;
+    return true;
+}
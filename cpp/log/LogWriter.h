@@ -0,0 +1,136 @@
+/*
+ * LogWriter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LOGWRITER_H_
+#define LOGWRITER_H_
+
+#include <stddef.h>
+#include <time.h>
+#include <vector>
+#include <boost/thread.hpp>
+#include "util/RealTime.h"
+
+class TimeIndexWriter;
+class ChecksumManifest;
+
+/**
+ * Block buffered writer for the text log (log.txt).
+ *
+ * Records are formatted straight into one of two blocks allocated by the
+ * constructor. When the block fills up or its oldest record is maxDelayMs
+ * old it is handed to a thread started in open(), which writes it out with
+ * a single write() while records go into the other block; a record only
+ * waits for the card when both blocks are full. The same thread watches
+ * the age, so a block goes out in time even if nothing else is logged and
+ * a crash loses at most maxDelayMs of records (plus a block being
+ * written). Appending a record never allocates. Records can be written
+ * from several threads.
+ */
+class LogWriter {
+public:
+    LogWriter(size_t blockSize = 16384, int maxDelayMs = 500);
+    ~LogWriter();
+
+    bool open(const char *path);
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+
+    /**
+     * Appends "<tag> <sec> <nsec> <text>\n".
+     */
+    void write(const char *tag, const timespec& stamp, const char *text, size_t length);
+
+    /**
+     * Appends "<tag> <sec> <nsec> @<utc sec>.<utc nsec> <text>\n", where utc is
+     * in nanoseconds since 1970. A negative utc is left out.
+     */
+    void write(const char *tag, const timespec& stamp, long long utc, const char *text, size_t length);
+
+    /**
+     * Appends "<tag> <sec> <nsec> <v0> <v1> ...\n" with values printed as %g.
+     */
+    void writeValues(const char *tag, const timespec& stamp, const float *values, int count);
+
+    /**
+     * Writes out the current block and waits until it is written.
+     */
+    void flush();
+
+    /**
+     * Scheduling for the thread writing the blocks. Applied now if the log
+     * is open and to the thread of every later open().
+     */
+    void setThreadPolicy(const ThreadPolicy& policy);
+
+    /**
+     * Adds a point to index (see LogIndex.h) for the first record at or
+     * after every intervalMs of record time. A null index stops indexing.
+     */
+    void setIndex(TimeIndexWriter *index, int intervalMs = 1000);
+
+    /**
+     * Records the CRC-32C of every block written in manifest, under name.
+     */
+    void setChecksums(ChecksumManifest *manifest, const char *name);
+
+    /**
+     * Size of the log so far, including records not yet flushed.
+     */
+    unsigned long long size() const;
+
+private:
+    int _fd;
+    std::vector<char> _blocks[2];
+    int _current;           // block records go into
+    size_t _used;
+    int _maxDelayMs;
+    timespec _oldest;
+    unsigned long long _flushed;    // log offset of the current block
+    // The other block, handed to the flusher and written outside _lock;
+    // none is waiting while _pendingUsed is 0
+    size_t _pendingUsed;
+    unsigned long long _pendingOffset;
+    TimeIndexWriter *_index;
+    long long _indexInterval;
+    long long _nextIndexStamp;
+    ChecksumManifest *_checksums;
+    const char *_checksumName;
+    mutable boost::mutex _lock;
+
+    // Writes out handed over blocks and those that reach _maxDelayMs, woken
+    // when a block is started or handed over
+    boost::thread _flusher;
+    boost::condition_variable _wakeFlusher;
+    boost::condition_variable _blockWritten;
+    bool _flusherRunning;
+    ThreadPolicy _threadPolicy;
+
+    void flusherRun();
+    void handOver(boost::mutex::scoped_lock& lock);
+    char *beginRecord(boost::mutex::scoped_lock& lock, const char *tag, const timespec& stamp,
+                      size_t payloadLength);
+    void endRecord(boost::mutex::scoped_lock& lock, char *end);
+};
+
+/**
+ * One record of log.txt as read back: "<tag> <sec> <nsec> <text>".
+ */
+struct LogRecord {
+    const char *tag;
+    size_t tagLength;
+    long long stamp;        // nanoseconds
+    long long utc;          // nanoseconds since 1970, or -1 if the record has none
+    const char *text;
+    size_t textLength;
+};
+
+/**
+ * Splits a line of log.txt (without the newline). Looks at no more than
+ * length bytes. Returns false if the line is not a record.
+ */
+bool parseLogRecord(const char *line, size_t length, LogRecord& record);
+
+#endif /* LOGWRITER_H_ */
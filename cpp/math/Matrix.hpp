@@ -0,0 +1,172 @@
+// =============================================================================
+// Fixed-size matrices for the on-board estimators
+// Created on: Oct 19, 2026
+// Sizes are template parameters, so all storage is inline and every loop has
+// a compile-time trip count the compiler can unroll. Nothing allocates.
+// =============================================================================
+
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <math.h>
+
+template <int Rows, int Cols, typename T = float>
+class Matrix
+{
+    public:
+        T m[Rows][Cols];
+
+        static Matrix zeros()
+        {
+            Matrix r;
+            for (int i = 0; i < Rows; i++)
+                for (int j = 0; j < Cols; j++)
+                    r.m[i][j] = 0;
+            return r;
+        }
+        static Matrix identity()
+        {
+            Matrix r = zeros();
+            for (int i = 0; i < Rows && i < Cols; i++)
+                r.m[i][i] = 1;
+            return r;
+        }
+
+        inline T& operator()(int row, int col) { return m[row][col]; }
+        inline const T& operator()(int row, int col) const { return m[row][col]; }
+        // Element access for vectors
+        inline T& operator[](int i) { return m[Cols == 1 ? i : 0][Cols == 1 ? 0 : i]; }
+        inline const T& operator[](int i) const { return m[Cols == 1 ? i : 0][Cols == 1 ? 0 : i]; }
+
+        inline Matrix operator+(const Matrix& o) const
+        {
+            Matrix r;
+            for (int i = 0; i < Rows; i++)
+                for (int j = 0; j < Cols; j++)
+                    r.m[i][j] = m[i][j] + o.m[i][j];
+            return r;
+        }
+        inline Matrix operator-(const Matrix& o) const
+        {
+            Matrix r;
+            for (int i = 0; i < Rows; i++)
+                for (int j = 0; j < Cols; j++)
+                    r.m[i][j] = m[i][j] - o.m[i][j];
+            return r;
+        }
+        inline Matrix operator*(T s) const
+        {
+            Matrix r;
+            for (int i = 0; i < Rows; i++)
+                for (int j = 0; j < Cols; j++)
+                    r.m[i][j] = m[i][j] * s;
+            return r;
+        }
+        inline Matrix& operator+=(const Matrix& o)
+        {
+            for (int i = 0; i < Rows; i++)
+                for (int j = 0; j < Cols; j++)
+                    m[i][j] += o.m[i][j];
+            return *this;
+        }
+        template <int K>
+        inline Matrix<Rows, K, T> operator*(const Matrix<Cols, K, T>& o) const
+        {
+            Matrix<Rows, K, T> r;
+            for (int i = 0; i < Rows; i++)
+                for (int j = 0; j < K; j++)
+                {
+                    T sum = 0;
+                    for (int k = 0; k < Cols; k++)
+                        sum += m[i][k] * o.m[k][j];
+                    r.m[i][j] = sum;
+                }
+            return r;
+        }
+        inline Matrix<Cols, Rows, T> transpose() const
+        {
+            Matrix<Cols, Rows, T> r;
+            for (int i = 0; i < Rows; i++)
+                for (int j = 0; j < Cols; j++)
+                    r.m[j][i] = m[i][j];
+            return r;
+        }
+};
+
+typedef Matrix<3, 1> Vector3f;
+typedef Matrix<3, 3> Matrix3f;
+
+inline Vector3f vector3(float x, float y, float z)
+{
+    Vector3f v;
+    v[0] = x; v[1] = y; v[2] = z;
+    return v;
+}
+
+inline float dot(const Vector3f& a, const Vector3f& b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline float norm(const Vector3f& a)
+{
+    return sqrtf(dot(a, a));
+}
+
+inline Vector3f cross(const Vector3f& a, const Vector3f& b)
+{
+    return vector3(a[1] * b[2] - a[2] * b[1],
+                   a[2] * b[0] - a[0] * b[2],
+                   a[0] * b[1] - a[1] * b[0]);
+}
+
+inline Matrix3f skew(const Vector3f& w)
+{
+    Matrix3f r;
+    r.m[0][0] = 0;     r.m[0][1] = -w[2]; r.m[0][2] = w[1];
+    r.m[1][0] = w[2];  r.m[1][1] = 0;     r.m[1][2] = -w[0];
+    r.m[2][0] = -w[1]; r.m[2][1] = w[0];  r.m[2][2] = 0;
+    return r;
+}
+
+// Rotation matrix of the rotation vector w (Rodrigues' formula)
+inline Matrix3f expSO3(const Vector3f& w)
+{
+    float theta2 = dot(w, w);
+    Matrix3f W = skew(w);
+    float a, b;
+    if (theta2 < 1e-8f)
+    {
+        a = 1.f - theta2 / 6.f;
+        b = 0.5f - theta2 / 24.f;
+    }
+    else
+    {
+        float theta = sqrtf(theta2);
+        a = sinf(theta) / theta;
+        b = (1.f - cosf(theta)) / theta2;
+    }
+    return Matrix3f::identity() + W * a + (W * W) * b;
+}
+
+// Pulls a rotation matrix that has drifted numerically back onto SO(3)
+inline void orthonormalize(Matrix3f& R)
+{
+    Vector3f x = vector3(R.m[0][0], R.m[0][1], R.m[0][2]);
+    Vector3f y = vector3(R.m[1][0], R.m[1][1], R.m[1][2]);
+    float error = dot(x, y) * 0.5f;
+    Vector3f xo = x - y * error;
+    Vector3f yo = y - x * error;
+    Vector3f zo = cross(xo, yo);
+    xo = xo * (0.5f * (3.f - dot(xo, xo)));
+    yo = yo * (0.5f * (3.f - dot(yo, yo)));
+    zo = zo * (0.5f * (3.f - dot(zo, zo)));
+    for (int j = 0; j < 3; j++)
+    {
+        R.m[0][j] = xo[j];
+        R.m[1][j] = yo[j];
+        R.m[2][j] = zo[j];
+    }
+}
+
+#endif
@@ -6,7 +6,48 @@
  */
 
 #include "ASIOSerialPort.h"
+#include <algorithm>
 #include <iostream>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// A single gather never exceeds these unless one message alone does, so a
+// high priority message waits behind at most ~130ms of data at 38400 baud.
+static const size_t kMaxTxBatchBytes = 512;
+static const size_t kMaxTxBatchBuffers = 32;
+
+// The event thread wakes up this often to notice stopEvents() on a silent port
+static const int kEventPollMs = 100;
+
+// A transmit stalled by the device (eg. flow control held) wakes up this often
+// to notice close(), and gives up on the batch after kTxStallMs without progress
+static const int kTxPollMs = 100;
+static const int kTxStallMs = 2000;
+
+static double secondsBetween(const timespec& start, const timespec& end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+static void addMilliseconds(timespec& t, int ms) {
+    t.tv_sec += ms / 1000;
+    t.tv_nsec += (ms % 1000) * 1000000L;
+    if(t.tv_nsec >= 1000000000L)
+    {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000L;
+    }
+}
+
+static bool makeDeadline(int timeoutMs, timespec& deadline) {
+    if(timeoutMs < 0)
+        return false;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    addMilliseconds(deadline, timeoutMs);
+    return true;
+}
 
 ASIOSerialPort::ASIOSerialPort(std::string port_name, size_t baud)
     : port(ioservice, port_name)
@@ -16,24 +57,44 @@ ASIOSerialPort::ASIOSerialPort(std::string port_name, size_t baud)
 		exit(1);
 	}
 
-	try {
-		port.set_option(boost::asio::serial_port_base::baud_rate(baud));
-		port.set_option(boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::none));
-		port.set_option(boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::one));
-	} catch(...) {
+	if( !configure(port, baud) ) {
 		std::cerr << "Failed to set all options on port: " << port_name << std::endl;
 		exit(1);
 	}
 
+    _portName = port_name;
+    _baud = baud;
+    _connected = true;
+    _closed = false;
+    _reopenDelayMs = kReopenFirstMs;
+    _reopenAttempts = 0;
 
+    _eventsEnabled = false;
     _packetHasBeenDefined = false;
     _hasEncounteredStartByte = false;
-	_line = "";
+    _rxBegin = 0;
+    _rxEnd = 0;
+
+    _txRunning = false;
+    _txQueueLimit = kDefaultWriteQueueLimit;
+    _txLatencySum = 0;
+    memset(&_txStats, 0, sizeof(_txStats));
 }
 
 void ASIOSerialPort::startEvents() {
     _eventsEnabled = true;
 	eventThread = boost::thread(boost::bind(&ASIOSerialPort::eventThreadRun, this));
+    if(!_threadPolicy.isDefault())
+        applyThreadPolicy(eventThread.native_handle(), _threadPolicy, "serial event");
+}
+
+void ASIOSerialPort::setThreadPolicy(const ThreadPolicy& policy) {
+    boost::mutex::scoped_lock lock(_txLock);
+    _threadPolicy = policy;
+    if(eventThread.joinable())
+        applyThreadPolicy(eventThread.native_handle(), policy, "serial event");
+    if(_txRunning)
+        applyThreadPolicy(_txThread.native_handle(), policy, "serial transmit");
 }
 
 void ASIOSerialPort::stopEvents() {
@@ -41,91 +102,642 @@ void ASIOSerialPort::stopEvents() {
 }
 
 void ASIOSerialPort::eventThreadRun() {
-    while(isConnected() && _eventsEnabled)
+    char chunk[256];
+    // Keeps running through disconnects, readSome() sleeps while the port is down
+    while(port.is_open() && _eventsEnabled)
     {
-            char in = read();
+        size_t numRead;
+        ReadStatus status = readSome(chunk, sizeof(chunk), numRead, kEventPollMs);
+        if(status == READ_ERROR)
+            _framer.reset();
+        // Lines are stamped as they come off the port, before any listener runs
+        timespec arrival;
+        clock_gettime(CLOCK_MONOTONIC, &arrival);
+        long long stamp = arrival.tv_sec * 1000000000LL + arrival.tv_nsec;
+        for(size_t i = 0; i < numRead; i++)
+        {
+            char in = chunk[i];
             onNewByte(in);
-            if(in == '\n' || in == '\r')
+            SerialLine line;
+            if(_framer.push(in, line))
             {
-                onNewLine(_line);
-                _line = "";
-            } else {
-                _line += in;
+                line.stamp = stamp;
+                onLineData(line);
+                if(!onNewLine.empty())
+                    onNewLine(std::string(line.data, line.length));
             }
+        }
     }
 }
 
 void ASIOSerialPort::close() {
+    stopTransmitThread();
+    {
+        boost::mutex::scoped_lock lock(portLocker);
+        _closed = true;
+        _connected = false;
+        _portChanged.notify_all();
+    }
 	port.close();
 }
 
 bool ASIOSerialPort::isConnected() {
-	return port.is_open();
+    boost::mutex::scoped_lock lock(portLocker);
+	return _connected && port.is_open();
 }
 
-void ASIOSerialPort::write(std::string s) {
-	boost::asio::write(port, boost::asio::buffer(s.c_str(),s.size()));
+bool ASIOSerialPort::configure(boost::asio::serial_port& p, size_t baud) {
+    boost::system::error_code err;
+    p.set_option(boost::asio::serial_port_base::baud_rate(baud), err);
+    if(!err)
+        p.set_option(boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::none), err);
+    if(!err)
+        p.set_option(boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::one), err);
+    return !err;
 }
 
-void ASIOSerialPort::write(char *msg, int length) {
-    boost::asio::write(port, boost::asio::buffer(msg, length));
+void ASIOSerialPort::portFailed(const boost::system::error_code& err) {
+    SerialConnectionChange change;
+    {
+        boost::mutex::scoped_lock lock(portLocker);
+        if(!_connected || _closed)
+            return;
+        _connected = false;
+        _reopenDelayMs = kReopenFirstMs;
+        _reopenAttempts = 0;
+        clock_gettime(CLOCK_MONOTONIC, &_disconnectedAt);
+        _nextReopen = _disconnectedAt;
+        addMilliseconds(_nextReopen, _reopenDelayMs);
+    }
+    std::string reason = err.message();
+    std::cerr << "Serial port " << _portName << " disconnected (" << reason << "), will reopen" << std::endl;
+    change.port = _portName.c_str();
+    change.reason = reason.c_str();
+    change.attempts = 0;
+    change.downSeconds = 0;
+    onDisconnect(change);
+}
+
+bool ASIOSerialPort::reconnect() {
+    SerialConnectionChange change;
+    {
+        boost::mutex::scoped_lock lock(portLocker);
+        if(_connected)
+            return true;
+        if(_closed)
+            return false;
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if(secondsBetween(now, _nextReopen) > 0)
+            return false;
+
+        // The device is opened and set up on its own, then moved onto the
+        // descriptor of the port; fresh closes its copy when it goes away
+        _reopenAttempts++;
+        boost::system::error_code err;
+        boost::asio::serial_port fresh(ioservice);
+        fresh.open(_portName, err);
+        if(err || !configure(fresh, _baud) || dup2(fresh.native_handle(), port.native_handle()) < 0)
+        {
+            _reopenDelayMs = std::min(2 * _reopenDelayMs, (int)kReopenMaxMs);
+            _nextReopen = now;
+            addMilliseconds(_nextReopen, _reopenDelayMs);
+            return false;
+        }
+        _connected = true;
+        change.attempts = _reopenAttempts;
+        change.downSeconds = secondsBetween(_disconnectedAt, now);
+        _portChanged.notify_all();
+    }
+    std::cerr << "Serial port " << _portName << " reconnected after " << change.downSeconds << " s" << std::endl;
+    change.port = _portName.c_str();
+    change.reason = "";
+    onReconnect(change);
+    return true;
+}
+
+ReadStatus ASIOSerialPort::waitForReconnect(const timespec& deadline, bool hasDeadline) {
+    while(!reconnect())
+    {
+        boost::mutex::scoped_lock lock(portLocker);
+        if(_closed)
+            return READ_ERROR;
+        if(_connected)
+            continue;
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        timespec wake = _nextReopen;
+        if(hasDeadline && secondsBetween(deadline, wake) > 0)
+            wake = deadline;
+        double wait = secondsBetween(now, wake);
+        if(hasDeadline && secondsBetween(now, deadline) <= 0)
+            return READ_ERROR;
+        // Woken early if another thread reconnects or closes the port
+        if(wait > 0)
+            _portChanged.timed_wait(lock, boost::posix_time::microseconds((long)(wait * 1e6) + 1));
+    }
+    return READ_OK;
+}
+
+void ASIOSerialPort::write(const std::string& s) {
+    write(s.c_str(), s.size());
+}
+
+void ASIOSerialPort::write(const char *msg, int length) {
+    boost::system::error_code err;
+    if(isConnected() || reconnect())
+        boost::asio::write(port, boost::asio::buffer(msg, length), err);
+    else
+        err = boost::asio::error::not_connected;
+    if(err)
+    {
+        portFailed(err);
+        throw boost::system::system_error(err);
+    }
+}
+
+void ASIOSerialPort::asyncWrite(const std::string& msg, WritePriority priority, WriteHandler onComplete) {
+    asyncWrite(msg.data(), msg.size(), priority, onComplete);
+}
+
+void ASIOSerialPort::setWriteQueueLimit(size_t maxMessages) {
+    boost::mutex::scoped_lock lock(_txLock);
+    _txQueueLimit = maxMessages;
+}
+
+void ASIOSerialPort::asyncWrite(const char *msg, size_t length, WritePriority priority, WriteHandler onComplete) {
+    // Completed outside the lock when the queue is full
+    WriteHandler dropped;
+    {
+        boost::mutex::scoped_lock lock(_txLock);
+        if(!makeRoom(priority, dropped))
+        {
+            lock.unlock();
+            if(onComplete)
+                onComplete(boost::asio::error::no_buffer_space, 0);
+            return;
+        }
+        queueWrite(msg, length, priority, onComplete);
+    }
+    if(dropped)
+        dropped(boost::asio::error::no_buffer_space, 0);
+}
+
+bool ASIOSerialPort::makeRoom(WritePriority priority, WriteHandler& dropped) {
+    size_t queued = 0;
+    for(int p = 0; p < WRITE_PRIORITY_COUNT; p++)
+        queued += _txQueue[p].size();
+    if(_txQueueLimit == 0 || queued < _txQueueLimit)
+        return true;
+
+    // The oldest message of the lowest priority makes room, unless the new
+    // one ranks below everything queued
+    int lowest = WRITE_PRIORITY_COUNT - 1;
+    while(_txQueue[lowest].empty())
+        lowest--;
+    _txStats.messagesDropped++;
+    if(lowest < priority)
+        return false;
+    boost::circular_buffer<PendingWrite>& queue = _txQueue[lowest];
+    dropped.swap(queue.front().onComplete);
+    _txStats.queuedMessages--;
+    _txStats.queuedBytes -= queue.front().data.size();
+    _txPool.push_back(std::string());
+    _txPool.back().swap(queue.front().data);
+    queue.pop_front();
+    return true;
+}
+
+void ASIOSerialPort::queueWrite(const char *msg, size_t length, WritePriority priority, WriteHandler& onComplete) {
+    boost::circular_buffer<PendingWrite>& queue = _txQueue[priority];
+    if(queue.full())
+        queue.set_capacity(queue.capacity() ? 2 * queue.capacity() : 16);
+    queue.push_back(PendingWrite());
+    if(!_txPool.empty())
+    {
+        queue.back().data.swap(_txPool.back());
+        _txPool.pop_back();
+    }
+    queue.back().data.assign(msg, length);
+    queue.back().onComplete.swap(onComplete);
+    clock_gettime(CLOCK_MONOTONIC, &queue.back().queued);
+    _txStats.queuedMessages++;
+    _txStats.queuedBytes += length;
+
+    if(!_txRunning)
+    {
+        // First queued write (or first since close()): spin up the transmit thread
+        _txRunning = true;
+        _txInFlight.reserve(kMaxTxBatchBuffers);
+        _txDone.reserve(kMaxTxBatchBuffers);
+        _txBuffers.reserve(kMaxTxBatchBuffers);
+        _txThread = boost::thread(boost::bind(&ASIOSerialPort::txThreadRun, this));
+        if(!_threadPolicy.isDefault())
+            applyThreadPolicy(_txThread.native_handle(), _threadPolicy, "serial transmit");
+    }
+    _txReady.notify_one();
+}
+
+size_t ASIOSerialPort::writeQueueDepth() {
+    boost::mutex::scoped_lock lock(_txLock);
+    return _txStats.queuedMessages;
+}
+
+WriteQueueStats ASIOSerialPort::writeStats() {
+    boost::mutex::scoped_lock lock(_txLock);
+    return _txStats;
+}
+
+void ASIOSerialPort::txThreadRun() {
+    boost::mutex::scoped_lock lock(_txLock);
+    while(_txRunning)
+    {
+        if(!gatherTransmit())
+        {
+            _txReady.wait(lock);
+            continue;
+        }
+        lock.unlock();
+        // One blocking gather write for the whole batch on this thread;
+        // unlike async_write and post() it needs no per-batch allocations
+        boost::system::error_code err;
+        if(!isConnected() && !reconnect())
+            err = boost::asio::error::not_connected;
+        else
+            err = writeBatch();
+        // A stall or close() ends the batch but says nothing about the device
+        if(err && err != boost::asio::error::timed_out && err != boost::asio::error::operation_aborted)
+            portFailed(err);
+        finishTransmit(err);
+        lock.lock();
+    }
+}
+
+bool ASIOSerialPort::gatherTransmit() {
+    size_t batchBytes = 0;
+    for(int p = 0; p < WRITE_PRIORITY_COUNT; p++)
+    {
+        boost::circular_buffer<PendingWrite>& queue = _txQueue[p];
+        while(!queue.empty())
+        {
+            size_t size = queue.front().data.size();
+            if(!_txInFlight.empty() &&
+               (batchBytes + size > kMaxTxBatchBytes || _txInFlight.size() >= kMaxTxBatchBuffers))
+                break;
+            _txInFlight.push_back(PendingWrite());
+            PendingWrite& w = _txInFlight.back();
+            w.data.swap(queue.front().data);
+            w.onComplete.swap(queue.front().onComplete);
+            w.queued = queue.front().queued;
+            queue.pop_front();
+            batchBytes += size;
+        }
+    }
+    if(_txInFlight.empty())
+        return false;
+
+    // Buffers are built only once the batch is complete, since growing
+    // _txInFlight may move short strings stored inline.
+    _txBuffers.clear();
+    for(size_t i = 0; i < _txInFlight.size(); i++)
+    {
+        iovec buffer;
+        buffer.iov_base = (void *)_txInFlight[i].data.data();
+        buffer.iov_len = _txInFlight[i].data.size();
+        _txBuffers.push_back(buffer);
+    }
+    return true;
+}
+
+boost::system::error_code ASIOSerialPort::writeBatch() {
+    // writev() rather than boost::asio::write(), which copies a vector
+    // buffer sequence on every call
+    iovec *buffers = &_txBuffers[0];
+    size_t count = _txBuffers.size();
+    int stalledMs = 0;
+    while(count > 0)
+    {
+        ssize_t n = ::writev(port.native_handle(), buffers, count);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            if(errno == EAGAIN)
+            {
+                pollfd pfd;
+                pfd.fd = port.native_handle();
+                pfd.events = POLLOUT;
+                pfd.revents = 0;
+                if(poll(&pfd, 1, kTxPollMs) == 0)
+                {
+                    boost::mutex::scoped_lock lock(_txLock);
+                    if(!_txRunning)
+                        return boost::asio::error::operation_aborted;
+                    stalledMs += kTxPollMs;
+                    if(stalledMs >= kTxStallMs)
+                        return boost::asio::error::timed_out;
+                }
+                continue;
+            }
+            return boost::system::error_code(errno, boost::system::system_category());
+        }
+        stalledMs = 0;
+        // The driver may take part of the batch, even part of one buffer
+        while(count > 0 && (size_t)n >= buffers->iov_len)
+        {
+            n -= buffers->iov_len;
+            buffers++;
+            count--;
+        }
+        if(count > 0)
+        {
+            buffers->iov_base = (char *)buffers->iov_base + n;
+            buffers->iov_len -= n;
+        }
+    }
+    return boost::system::error_code();
+}
+
+void ASIOSerialPort::finishTransmit(const boost::system::error_code& err) {
+    // _txDone is only touched on the transmit thread; swapping keeps both capacities
+    std::vector<PendingWrite>& done = _txDone;
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    {
+        boost::mutex::scoped_lock lock(_txLock);
+        done.swap(_txInFlight);
+        for(size_t i = 0; i < done.size(); i++)
+        {
+            double latency = secondsBetween(done[i].queued, now);
+            _txStats.queuedMessages--;
+            _txStats.queuedBytes -= done[i].data.size();
+            if(err)
+            {
+                _txStats.writeErrors++;
+                continue;
+            }
+            _txStats.messagesSent++;
+            _txStats.bytesSent += done[i].data.size();
+            _txStats.lastLatency = latency;
+            if(latency > _txStats.maxLatency)
+                _txStats.maxLatency = latency;
+            _txLatencySum += latency;
+            _txStats.meanLatency = _txLatencySum / _txStats.messagesSent;
+        }
+    }
+    // Batches dropped while the port is down or closing are not worth a line each
+    if(err && err != boost::asio::error::not_connected && err != boost::asio::error::operation_aborted)
+        std::cerr << "Error writing stream: " << err.message() << std::endl;
+
+    for(size_t i = 0; i < done.size(); i++)
+    {
+        if(done[i].onComplete)
+            done[i].onComplete(err, err ? 0 : done[i].data.size());
+    }
+    boost::mutex::scoped_lock lock(_txLock);
+    for(size_t i = 0; i < done.size(); i++)
+    {
+        _txPool.push_back(std::string());
+        _txPool.back().swap(done[i].data);
+    }
+    done.clear();
+}
+
+void ASIOSerialPort::stopTransmitThread() {
+    {
+        boost::mutex::scoped_lock lock(_txLock);
+        _txRunning = false;
+        _txReady.notify_one();
+    }
+    if(_txThread.joinable())
+        _txThread.join();
+
+    // Messages that never went out still complete, so callers counting
+    // completions hear about every one of them
+    std::vector<PendingWrite> aborted;
+    {
+        boost::mutex::scoped_lock lock(_txLock);
+        aborted.swap(_txInFlight);
+        for(int p = 0; p < WRITE_PRIORITY_COUNT; p++)
+        {
+            boost::circular_buffer<PendingWrite>& queue = _txQueue[p];
+            for(; !queue.empty(); queue.pop_front())
+            {
+                aborted.push_back(PendingWrite());
+                aborted.back().data.swap(queue.front().data);
+                aborted.back().onComplete.swap(queue.front().onComplete);
+            }
+        }
+        _txStats.queuedMessages = 0;
+        _txStats.queuedBytes = 0;
+    }
+    for(size_t i = 0; i < aborted.size(); i++)
+    {
+        if(aborted[i].onComplete)
+            aborted[i].onComplete(boost::asio::error::operation_aborted, 0);
+    }
+}
+
+ReadStatus ASIOSerialPort::waitReadable(const timespec& deadline, bool hasDeadline,
+                                        boost::system::error_code& err) {
+    pollfd pfd;
+    int ready;
+    do
+    {
+        // Recomputed on every pass, a signal must not stretch the deadline
+        int timeoutMs = -1;
+        if(hasDeadline)
+        {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            double remaining = secondsBetween(now, deadline);
+            if(remaining <= 0)
+                return READ_TIMEOUT;
+            timeoutMs = (int)(remaining * 1000.0 + 0.999);
+        }
+        pfd.fd = port.native_handle();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        ready = poll(&pfd, 1, timeoutMs);
+    } while(ready < 0 && errno == EINTR);
+    if(ready < 0)
+    {
+        err = boost::system::error_code(errno, boost::system::system_category());
+        return READ_ERROR;
+    }
+    if(ready == 0)
+        return READ_TIMEOUT;
+    // Whatever is left is read before a hang up is reported
+    if(pfd.revents & POLLIN)
+        return READ_OK;
+    if(pfd.revents & POLLNVAL)
+        err = boost::asio::error::bad_descriptor;
+    else if(pfd.revents & POLLHUP)
+        err = boost::asio::error::eof;
+    else
+        err = boost::system::error_code(EIO, boost::system::system_category());
+    return READ_ERROR;
+}
+
+ReadStatus ASIOSerialPort::readFromPort(char *buf, size_t maxBytes, size_t& bytesRead,
+                                        const timespec& deadline, bool hasDeadline) {
+    bytesRead = 0;
+    while(true)
+    {
+        if(!isConnected())
+        {
+            ReadStatus status = waitForReconnect(deadline, hasDeadline);
+            if(status != READ_OK)
+                return status;
+        }
+
+        boost::system::error_code err;
+        ReadStatus status = waitReadable(deadline, hasDeadline, err);
+        if(status == READ_ERROR)
+            portFailed(err);
+        if(status != READ_OK)
+            return status;
+
+        bytesRead = port.read_some(boost::asio::buffer(buf, maxBytes), err);
+        if(bytesRead > 0)
+            return READ_OK;
+        if(err && err != boost::asio::error::would_block && err != boost::asio::error::try_again)
+        {
+            portFailed(err);
+            return READ_ERROR;
+        }
+    }
+}
+
+ReadStatus ASIOSerialPort::fillRxBuffer(const timespec& deadline, bool hasDeadline) {
+    if(_rxBegin == _rxEnd)
+    {
+        _rxBegin = 0;
+        _rxEnd = 0;
+    }
+    else if(_rxEnd == kRxBufferSize)
+    {
+        memmove(_rxBuffer, _rxBuffer + _rxBegin, _rxEnd - _rxBegin);
+        _rxEnd -= _rxBegin;
+        _rxBegin = 0;
+    }
+    size_t numRead;
+    ReadStatus status = readFromPort(_rxBuffer + _rxEnd, kRxBufferSize - _rxEnd, numRead, deadline, hasDeadline);
+    _rxEnd += numRead;
+    return status;
+}
+
+size_t ASIOSerialPort::takeBuffered(char *buf, size_t maxBytes) {
+    size_t n = std::min(maxBytes, _rxEnd - _rxBegin);
+    memcpy(buf, _rxBuffer + _rxBegin, n);
+    _rxBegin += n;
+    return n;
+}
+
+ReadStatus ASIOSerialPort::readExactly(char *buf, size_t numBytes, size_t& bytesRead, int timeoutMs) {
+    timespec deadline;
+    bool hasDeadline = makeDeadline(timeoutMs, deadline);
+
+    // Drain what is already buffered, then read straight into the caller's buffer
+    bytesRead = takeBuffered(buf, numBytes);
+    while(bytesRead < numBytes)
+    {
+        size_t numRead;
+        ReadStatus status = readFromPort(buf + bytesRead, numBytes - bytesRead, numRead, deadline, hasDeadline);
+        bytesRead += numRead;
+        if(status != READ_OK)
+            return status;
+    }
+    return READ_OK;
+}
+
+ReadStatus ASIOSerialPort::readSome(char *buf, size_t maxBytes, size_t& bytesRead, int timeoutMs) {
+    bytesRead = takeBuffered(buf, maxBytes);
+    if(bytesRead > 0 || maxBytes == 0)
+        return READ_OK;
+
+    timespec deadline;
+    bool hasDeadline = makeDeadline(timeoutMs, deadline);
+    return readFromPort(buf, maxBytes, bytesRead, deadline, hasDeadline);
+}
+
+ReadStatus ASIOSerialPort::readUntil(char *buf, size_t maxBytes, const char *delimiters,
+                                     size_t& bytesRead, int timeoutMs) {
+    timespec deadline;
+    bool hasDeadline = makeDeadline(timeoutMs, deadline);
+
+    bytesRead = 0;
+    while(true)
+    {
+        size_t available = _rxEnd - _rxBegin;
+        size_t span = findDelimiter(_rxBuffer + _rxBegin, available, delimiters);
+        size_t take = std::min(span, maxBytes - bytesRead);
+        memcpy(buf + bytesRead, _rxBuffer + _rxBegin, take);
+        bytesRead += take;
+        _rxBegin += take;
+        if(take < span)
+            return READ_OVERFLOW;
+        if(span < available)
+        {
+            _rxBegin++;
+            return READ_OK;
+        }
+        ReadStatus status = fillRxBuffer(deadline, hasDeadline);
+        if(status != READ_OK)
+            return status;
+    }
 }
 
 std::string ASIOSerialPort::readln() {
-	char c;
-	std::string line;
-	int nTimes = 0;
-
-
-	while(true) {
-		try {
-            boost::asio::read(port, boost::asio::buffer(&c,1));
-		} catch(boost::exception_detail::clone_impl<boost::exception_detail::error_info_injector<boost::system::system_error> >& err) {
-			std::cerr << "Error reading stream. Device may have been unplugged." << std::endl;
-			std::cout<<"Error reading stream. Device may have been unplugged."<<std::endl;
-			std::cout<<nTimes<<std::endl;
-			return line;
-		}
-		switch(c) {
-		case '\r':
-            _eventsEnabled = true;
-			return line;
-			break;
-		case '\n':
-			return line;
-			break;
-		default:
-			line += c;
-			nTimes++;
-			//std::cout<<nTimes<<std::endl;
-			break;
-		}
-		if(_packetHasBeenDefined)
-		{
-		    if(c==_packetStartByte)
-		    {
-		        _packet = "";
-		        _hasEncounteredStartByte = true;
-		    }
-		    if(_hasEncounteredStartByte)
-		    {
-		        _packet += c;
-		    }
-		    if(c==_packetEndByte)
-		    {
-                onNewPacket(_packet);
-                _hasEncounteredStartByte = false;
-		    }
-		}
-	}
-	return "";
+    char chunk[256];
+    std::string line;
+    size_t numRead;
+    ReadStatus status;
+
+    while(true)
+    {
+        status = readUntil(chunk, sizeof(chunk), "\r\n", numRead);
+        line.append(chunk, numRead);
+        if(status == READ_OK)
+            break;
+        if(status == READ_ERROR)
+        {
+            // Drop the partial line; the next read waits for the port to come back
+            line.clear();
+            boost::mutex::scoped_lock lock(portLocker);
+            if(_closed)
+                return line;
+        }
+    }
+    if(_packetHasBeenDefined)
+    {
+        for(size_t i = 0; i < line.size(); i++)
+            handlePacketByte(line[i]);
+    }
+    return line;
+}
+
+void ASIOSerialPort::handlePacketByte(char c) {
+    if(c==_packetStartByte)
+    {
+        _packet = "";
+        _hasEncounteredStartByte = true;
+    }
+    if(_hasEncounteredStartByte)
+    {
+        _packet += c;
+    }
+    if(c==_packetEndByte)
+    {
+        onNewPacket(_packet);
+        _hasEncounteredStartByte = false;
+    }
 }
 
 char ASIOSerialPort::read() {
     char in;
-    try {
-        boost::asio::read(port, boost::asio::buffer(&in, 1));
-    } catch (boost::exception_detail::clone_impl<boost::exception_detail::error_info_injector<boost::system::system_error> >& err) {
+    size_t numRead;
+    if(readExactly(&in, 1, numRead) != READ_OK) {
         std::cerr << "Error reading stream. Device may have been unplugged." << std::endl;
         return 0;
     }
@@ -134,9 +746,11 @@ char ASIOSerialPort::read() {
 
 char* ASIOSerialPort::read(int numBytes) {
     char* bytes = new char[numBytes];
-    for(int i = 0; i < numBytes; i++)
+    size_t numRead;
+    if(readExactly(bytes, numBytes, numRead) != READ_OK)
     {
-        bytes[i] = read();
+        std::cerr << "Error reading stream. Device may have been unplugged." << std::endl;
+        memset(bytes + numRead, 0, numBytes - numRead);
     }
     return bytes;
 }
@@ -149,4 +763,5 @@ void ASIOSerialPort::definePacket(char startByte, char endByte)
 }
 
 ASIOSerialPort::~ASIOSerialPort() {
+    stopTransmitThread();
 }
@@ -10,17 +10,89 @@
 
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/circular_buffer.hpp>
+#include <vector>
 #include <string>
+#include <sys/uio.h>
 #include <events/Event.hpp>
+#include <util/RealTime.h>
+#include "LineFramer.h"
 
 using namespace std;
 
+/**
+ * Priority of a message queued with ASIOSerialPort::asyncWrite().
+ * Higher priority messages are sent before anything of lower priority that
+ * has not yet been handed to the driver.
+ */
+enum WritePriority {
+    WRITE_PRIORITY_HIGH = 0,
+    WRITE_PRIORITY_NORMAL = 1,
+    WRITE_PRIORITY_LOW = 2,
+    WRITE_PRIORITY_COUNT
+};
+
+/**
+ * Snapshot of the transmit queue of a port, see ASIOSerialPort::writeStats().
+ * Latencies are measured from asyncWrite() to write completion, in seconds.
+ */
+struct WriteQueueStats {
+    size_t queuedMessages;
+    size_t queuedBytes;
+    unsigned long long messagesSent;
+    unsigned long long bytesSent;
+    unsigned long long writeErrors;
+    unsigned long long messagesDropped;     // to the queue limit
+    double lastLatency;
+    double meanLatency;
+    double maxLatency;
+};
+
+/**
+ * Result of the deadline-aware read methods of ASIOSerialPort.
+ */
+enum ReadStatus {
+    READ_OK,        // the request was satisfied
+    READ_TIMEOUT,   // the deadline expired first; bytesRead holds what did arrive
+    READ_OVERFLOW,  // readUntil() filled the buffer before finding a delimiter
+    READ_ERROR      // the port failed (eg. device unplugged) or is still disconnected
+};
+
+/**
+ * Pass as timeoutMs to the read methods to wait without a deadline.
+ */
+static const int READ_WAIT_FOREVER = -1;
+
+/**
+ * Passed to the onDisconnect and onReconnect events of ASIOSerialPort.
+ * Only valid during the event.
+ */
+struct SerialConnectionChange {
+    const char *port;           // device path the port was opened with
+    const char *reason;         // what failed, for onDisconnect; "" for onReconnect
+    unsigned int attempts;      // reopen attempts it took, for onReconnect
+    double downSeconds;         // time without the device, for onReconnect
+};
+
 /**
  * This is a helper class to simplify the interface for interacting with serial ports.
  *
+ * A port that fails (eg. the device is unplugged) is marked disconnected and
+ * reopened by path on a backoff timer, from kReopenFirstMs doubling up to
+ * kReopenMaxMs between attempts. Reopening happens on whichever thread next
+ * reads or writes; readers sleep until the next attempt or their deadline,
+ * so a dead device costs no CPU. The device is reopened onto the same file
+ * descriptor, so other threads never see a stale one.
  */
 class ASIOSerialPort {
 public:
+    /**
+     * Called once a queued message has been written (or failed to be written).
+     * Runs on the transmit thread of the port, so it must not block.
+     */
+    typedef boost::function<void (const boost::system::error_code&, size_t)> WriteHandler;
+
 	/**
 	 * The constructor takes in the path to the port (eg. "/dev/ttyUSB0") and a baud rate for the connection and opens the connection.
 	 */
@@ -38,29 +110,111 @@ public:
       */
       void stopEvents();
 
+    /**
+     * Scheduling for the event and transmit threads of this port. Applied
+     * to threads already running and to those started later.
+     */
+    void setThreadPolicy(const ThreadPolicy& policy);
+
 	/**
 	 * Closes the serial connection.
 	 */
 	void close();
 
 	/**
-	 * Returns true if the serial port is connected and open
+	 * Returns true if the serial port is open and has not failed since it was last (re)opened.
 	 */
 	bool isConnected();
 
 	/**
 	 * Writes the given string to the serial port.
+	 * Blocks until the whole string has been written.
+	 * Throws boost::system::system_error if the port is disconnected or fails.
 	 */
-	void write(std::string msg);
+	void write(const std::string& msg);
 
     /**
      * Writes the given array of chars to the serial port.
+     * Blocks until the whole array has been written.
      */
-	void write(char *msg, int length);
+	void write(const char *msg, int length);
+
+    /**
+     * Queues a copy of the given string for transmission and returns immediately.
+     * Queued messages are drained in priority-ordered batches by the transmit
+     * thread of the port; onComplete (if set) is called when the message is out,
+     * or with boost::asio::error::operation_aborted if the port is closed first.
+     * A batch the device takes nothing of for two seconds (eg. flow control
+     * held) completes with boost::asio::error::timed_out.
+     * While the queue holds its limit of messages, the oldest message of the
+     * lowest queued priority is dropped to make room, or the new one if its
+     * priority is lower still; the dropped one completes with
+     * boost::asio::error::no_buffer_space.
+     * Once the queue has warmed up this does not allocate.
+     * Do not mix with the blocking write() on the same port.
+     */
+    void asyncWrite(const std::string& msg,
+                    WritePriority priority = WRITE_PRIORITY_NORMAL,
+                    WriteHandler onComplete = WriteHandler());
+
+    /**
+     * Queues a copy of the given array of chars for transmission.
+     * See asyncWrite(const std::string&, ...).
+     */
+    void asyncWrite(const char *msg, size_t length,
+                    WritePriority priority = WRITE_PRIORITY_NORMAL,
+                    WriteHandler onComplete = WriteHandler());
+
+    /**
+     * Most messages waiting in the transmit queue (not counting the batch
+     * being written); 0 for no limit. Defaults to kDefaultWriteQueueLimit.
+     */
+    void setWriteQueueLimit(size_t maxMessages);
+
+    static const size_t kDefaultWriteQueueLimit = 256;
+
+    /**
+     * Returns the number of messages waiting in or being written from the transmit queue.
+     */
+    size_t writeQueueDepth();
+
+    /**
+     * Returns the current transmit queue depth and latency statistics.
+     */
+    WriteQueueStats writeStats();
+
+    /**
+     * Reads exactly numBytes bytes into buf, waiting at most timeoutMs milliseconds.
+     * bytesRead is set to the number of bytes stored, which is less than
+     * numBytes only if the deadline expired or the port failed.
+     * The read methods return READ_ERROR as soon as the port fails; while it
+     * is disconnected they wait for it to come back, returning READ_ERROR if
+     * the deadline expires first.
+     */
+    ReadStatus readExactly(char *buf, size_t numBytes, size_t& bytesRead,
+                           int timeoutMs = READ_WAIT_FOREVER);
+
+    /**
+     * Reads whatever is available, up to maxBytes bytes, into buf.
+     * Waits at most timeoutMs milliseconds for the first byte to arrive.
+     */
+    ReadStatus readSome(char *buf, size_t maxBytes, size_t& bytesRead,
+                        int timeoutMs = READ_WAIT_FOREVER);
+
+    /**
+     * Reads bytes into buf until one of the characters in delimiters is found.
+     * The delimiter is consumed but not stored. Bytes that arrived before a
+     * timeout or overflow are consumed and returned, so callers reading lines
+     * in pieces should append the next call to what they already have.
+     */
+    ReadStatus readUntil(char *buf, size_t maxBytes, const char *delimiters,
+                         size_t& bytesRead, int timeoutMs = READ_WAIT_FOREVER);
 
 	/**
 	 * Reads bytes from the serial port until \n or \r is found.
 	 * Returns a string containing the bytes read excluding the newline.
+	 * A line cut short by a disconnect is dropped and reading goes on once
+	 * the port is back; an empty string is returned only after close().
 	 */
 	std::string readln();
 
@@ -72,7 +226,8 @@ public:
 
     /**
      * Reads numBytes bytes from the serial port.
-     * Returns an array containing the read bytes.
+     * Returns an array containing the read bytes, which the caller must delete[].
+     * Prefer readExactly(), which reads into a buffer owned by the caller.
      */
      char* read(int numBytes);
 
@@ -82,20 +237,104 @@ public:
       */
      void definePacket(char startByte, char endByte);
 
+    /**
+     * Fired by the event thread for every line. onLineData does not allocate;
+     * onNewLine builds a string only if somebody subscribed to it.
+     */
     Event<string> onNewLine;
+    Event<const SerialLine&> onLineData;
     Event<char> onNewByte;
     Event<string> onNewPacket;
 
+    /**
+     * Fired when the port fails and when it has been reopened, on the
+     * thread that noticed (the event thread, a reading thread or the
+     * transmit thread).
+     */
+    Event<const SerialConnectionChange&> onDisconnect;
+    Event<const SerialConnectionChange&> onReconnect;
+
+    /**
+     * Delays between attempts to reopen a failed port.
+     */
+    static const int kReopenFirstMs = 100;
+    static const int kReopenMaxMs = 5000;
+
+    /**
+     * Longest line delivered by the line events; longer lines are cut here.
+     */
+    static const size_t kMaxLineLength = LineFramer::kMaxLineLength;
+
 	~ASIOSerialPort();
 private:
 	boost::asio::io_service ioservice;
 	boost::asio::serial_port port;
 
 	boost::thread eventThread;
+	ThreadPolicy _threadPolicy;
 	boost::mutex portLocker;
 	void eventThreadRun();
 
+    // Connection state, guarded by portLocker
+    std::string _portName;
+    size_t _baud;
+    bool _connected;
+    bool _closed;
+    int _reopenDelayMs;
+    unsigned int _reopenAttempts;
+    timespec _nextReopen;
+    timespec _disconnectedAt;
+    boost::condition_variable _portChanged;
+
+    static bool configure(boost::asio::serial_port& p, size_t baud);
+    void portFailed(const boost::system::error_code& err);
+    bool reconnect();
+    ReadStatus waitForReconnect(const timespec& deadline, bool hasDeadline);
+
+    struct PendingWrite {
+        std::string data;
+        WriteHandler onComplete;
+        timespec queued;
+    };
+
+    // Transmit thread: waits for queued messages and writes them out in batches
+    boost::thread _txThread;
+    boost::mutex _txLock;
+    boost::condition_variable _txReady;
+    bool _txRunning;
+    size_t _txQueueLimit;
+    boost::circular_buffer<PendingWrite> _txQueue[WRITE_PRIORITY_COUNT];
+    std::vector<PendingWrite> _txInFlight;
+    std::vector<PendingWrite> _txDone;
+    // Message buffers are recycled so steady state writes don't allocate
+    std::vector<std::string> _txPool;
+    std::vector<iovec> _txBuffers;
+    WriteQueueStats _txStats;
+    double _txLatencySum;
+
+    bool makeRoom(WritePriority priority, WriteHandler& dropped);
+    void queueWrite(const char *msg, size_t length, WritePriority priority, WriteHandler& onComplete);
+    void txThreadRun();
+    bool gatherTransmit();
+    boost::system::error_code writeBatch();
+    void finishTransmit(const boost::system::error_code& err);
+    void stopTransmitThread();
+
 	bool _eventsEnabled;
+
+    // Bytes received from the port but not yet handed to a reader
+    static const size_t kRxBufferSize = 1024;
+    char _rxBuffer[kRxBufferSize];
+    size_t _rxBegin;
+    size_t _rxEnd;
+
+    ReadStatus waitReadable(const timespec& deadline, bool hasDeadline,
+                            boost::system::error_code& err);
+    ReadStatus readFromPort(char *buf, size_t maxBytes, size_t& bytesRead,
+                            const timespec& deadline, bool hasDeadline);
+    ReadStatus fillRxBuffer(const timespec& deadline, bool hasDeadline);
+    size_t takeBuffered(char *buf, size_t maxBytes);
+    void handlePacketByte(char c);
 
 	char _packetStartByte;
 	char _packetEndByte;
@@ -103,7 +342,7 @@ private:
 	bool _hasEncounteredStartByte;
 	string _packet;
 
-	string _line;
+	LineFramer _framer;
 
 };
 
@@ -0,0 +1,33 @@
+/*
+ * LineFramer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "LineFramer.h"
+#include <string.h>
+
+size_t findDelimiter(const char *data, size_t length, const char *delimiters) {
+    // Delimiter sets are one or two characters ("\n", "\r\n"), so test those
+    // directly rather than calling strchr() for every byte
+    char first = delimiters[0];
+    char second = first ? delimiters[1] : '\0';
+    if(second && delimiters[2])
+    {
+        for(size_t i = 0; i < length; i++)
+            if(data[i] != '\0' && strchr(delimiters, data[i]))
+                return i;
+        return length;
+    }
+    if(!first)
+        return length;
+    if(!second)
+    {
+        const void *found = memchr(data, first, length);
+        return found ? (const char *)found - data : length;
+    }
+    for(size_t i = 0; i < length; i++)
+        if(data[i] == first || data[i] == second)
+            return i;
+    return length;
+}
@@ -0,0 +1,69 @@
+/*
+ * LineFramer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LINEFRAMER_H_
+#define LINEFRAMER_H_
+
+#include <stddef.h>
+
+/**
+ * A line received by the event thread, without the newline.
+ * Only valid during the onLineData event.
+ */
+struct SerialLine {
+    const char *data;
+    size_t length;
+    // CLOCK_MONOTONIC nanoseconds when the bytes ending the line were read,
+    // set by the event thread; listeners that run late still see arrival
+    long long stamp;
+};
+
+/**
+ * Cuts a byte stream into lines ending in \n or \r, as the event thread of
+ * ASIOSerialPort does. Lines longer than kMaxLineLength are cut there.
+ * Does not allocate.
+ */
+class LineFramer {
+public:
+    static const size_t kMaxLineLength = 512;
+
+    LineFramer() : _length(0) {}
+
+    /**
+     * Adds a byte. Returns true if it ended a line, which is then in line
+     * until the next call.
+     */
+    bool push(char c, SerialLine& line) {
+        if(c == '\n' || c == '\r')
+        {
+            line.data = _line;
+            line.length = _length;
+            line.stamp = 0;
+            _length = 0;
+            return true;
+        }
+        if(_length < kMaxLineLength)
+            _line[_length++] = c;
+        return false;
+    }
+
+    /**
+     * Drops the line received so far.
+     */
+    void reset() { _length = 0; }
+
+private:
+    char _line[kMaxLineLength];
+    size_t _length;
+};
+
+/**
+ * Returns the position of the first of the characters in delimiters in
+ * data, or length if there is none.
+ */
+size_t findDelimiter(const char *data, size_t length, const char *delimiters);
+
+#endif /* LINEFRAMER_H_ */
@@ -0,0 +1,111 @@
+/*
+ * BitStream.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef BITSTREAM_H_
+#define BITSTREAM_H_
+
+#include <stddef.h>
+
+/**
+ * Packs values of arbitrary bit width (up to 32) into a byte buffer, LSB first.
+ */
+class BitWriter {
+public:
+    BitWriter(unsigned char *buf, size_t capacity)
+        : _buf(buf), _capacity(capacity), _bytes(0), _acc(0), _bits(0), _overflow(false) {}
+
+    inline void put(unsigned long long value, int bits) {
+        if(bits < 64)
+            value &= (1ULL << bits) - 1;
+        _acc |= value << _bits;
+        _bits += bits;
+        while(_bits >= 8)
+        {
+            emit((unsigned char)_acc);
+            _acc >>= 8;
+            _bits -= 8;
+        }
+    }
+
+    /**
+     * Writes out any partial byte and returns the number of bytes used.
+     */
+    inline size_t finish() {
+        if(_bits > 0)
+        {
+            emit((unsigned char)_acc);
+            _acc = 0;
+            _bits = 0;
+        }
+        return _bytes;
+    }
+
+    bool overflow() const { return _overflow; }
+
+private:
+    unsigned char *_buf;
+    size_t _capacity;
+    size_t _bytes;
+    unsigned long long _acc;
+    int _bits;
+    bool _overflow;
+
+    inline void emit(unsigned char b) {
+        if(_bytes < _capacity)
+            _buf[_bytes++] = b;
+        else
+            _overflow = true;
+    }
+};
+
+/**
+ * Reads back values written by BitWriter.
+ */
+class BitReader {
+public:
+    BitReader(const unsigned char *buf, size_t size)
+        : _buf(buf), _size(size), _pos(0), _acc(0), _bits(0), _underflow(false) {}
+
+    inline unsigned long long get(int bits) {
+        while(_bits < bits)
+        {
+            unsigned long long b = 0;
+            if(_pos < _size)
+                b = _buf[_pos++];
+            else
+                _underflow = true;
+            _acc |= b << _bits;
+            _bits += 8;
+        }
+        unsigned long long value = bits < 64 ? _acc & ((1ULL << bits) - 1) : _acc;
+        _acc >>= bits;
+        _bits -= bits;
+        return value;
+    }
+
+    bool underflow() const { return _underflow; }
+
+private:
+    const unsigned char *_buf;
+    size_t _size;
+    size_t _pos;
+    unsigned long long _acc;
+    int _bits;
+    bool _underflow;
+};
+
+/**
+ * Maps signed values to unsigned so small magnitudes need few bits.
+ */
+inline unsigned long long zigzagEncode(long long v) {
+    return ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63);
+}
+
+inline long long zigzagDecode(unsigned long long v) {
+    return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+#endif /* BITSTREAM_H_ */
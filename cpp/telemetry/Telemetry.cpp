@@ -0,0 +1,312 @@
+/*
+ * Telemetry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Telemetry.h"
+#include "BitStream.h"
+#include <math.h>
+#include <string.h>
+
+static const unsigned char kSync0 = 0xA5;
+static const unsigned char kSync1 = 0x5A;
+static const unsigned char kKeyFlag = 0x80;
+static const size_t kHeaderSize = 6;
+static const size_t kCrcSize = 2;
+
+// Deltas wider than this are sent as a key frame instead
+static const int kMaxDeltaBits = 24;
+static const int kDeltaWidthBits = 5;
+
+struct FieldSpec {
+    const char *name;
+    int bits;
+    bool isSigned;
+    double scale;
+};
+
+static const FieldSpec kAttitudeFields[] = {
+    { "time",  32, false, 1e-3 },
+    { "roll",  16, true,  1e-4 },
+    { "pitch", 16, true,  1e-4 },
+    { "yaw",   16, true,  1e-4 }
+};
+
+static const FieldSpec kGpsFields[] = {
+    { "time",       32, false, 1e-3 },
+    { "lat",        32, true,  1e-7 },
+    { "lon",        32, true,  1e-7 },
+    { "alt",        24, true,  1e-1 },
+    { "speed",      16, false, 1e-2 },
+    { "course",     16, false, 1e-2 },
+    { "fix",         3, false, 1 },
+    { "satellites",  5, false, 1 }
+};
+
+static const FieldSpec kCameraFields[] = {
+    { "time",      32, false, 1e-3 },
+    { "frames",    24, false, 1 },
+    { "dropped",   16, false, 1 },
+    { "keypoints", 16, false, 1 }
+};
+
+struct TypeSpec {
+    const char *name;
+    const FieldSpec *fields;
+    int count;
+};
+
+static const TypeSpec kTypes[TELEMETRY_TYPE_COUNT] = {
+    { "att", kAttitudeFields, 4 },
+    { "gps", kGpsFields, 8 },
+    { "cam", kCameraFields, 4 }
+};
+
+int telemetryFieldCount(TelemetryType type) { return kTypes[type].count; }
+const char *telemetryTypeName(TelemetryType type) { return kTypes[type].name; }
+const char *telemetryFieldName(TelemetryType type, int field) { return kTypes[type].fields[field].name; }
+double telemetryFieldScale(TelemetryType type, int field) { return kTypes[type].fields[field].scale; }
+
+static long long quantize(double value, double scale) {
+    return (long long)floor(value / scale + 0.5);
+}
+
+static long long timeField(long long stamp) {
+    return (stamp / 1000000) & 0xFFFFFFFFLL;
+}
+
+TelemetryMessage attitudeTelemetry(long long stamp, float roll, float pitch, float yaw) {
+    TelemetryMessage m;
+    memset(&m, 0, sizeof(m));
+    m.type = TELEMETRY_ATTITUDE;
+    m.values[0] = timeField(stamp);
+    m.values[1] = quantize(roll, 1e-4);
+    m.values[2] = quantize(pitch, 1e-4);
+    m.values[3] = quantize(yaw, 1e-4);
+    return m;
+}
+
+TelemetryMessage gpsTelemetry(const GpsFix& fix) {
+    TelemetryMessage m;
+    memset(&m, 0, sizeof(m));
+    m.type = TELEMETRY_GPS;
+    m.values[0] = timeField(fix.stamp);
+    m.values[1] = quantize(fix.latitude, 1e-7);
+    m.values[2] = quantize(fix.longitude, 1e-7);
+    m.values[3] = quantize(fix.altitude, 1e-1);
+    m.values[4] = quantize(fix.speed, 1e-2);
+    m.values[5] = quantize(fix.course, 1e-2);
+    m.values[6] = fix.fixQuality;
+    m.values[7] = fix.satellites;
+    return m;
+}
+
+TelemetryMessage cameraTelemetry(long long stamp, unsigned long long frames,
+                                 unsigned long long dropped, unsigned int keypoints) {
+    TelemetryMessage m;
+    memset(&m, 0, sizeof(m));
+    m.type = TELEMETRY_CAMERA;
+    m.values[0] = timeField(stamp);
+    m.values[1] = (long long)frames;
+    m.values[2] = (long long)dropped;
+    m.values[3] = keypoints;
+    return m;
+}
+
+// Wraps a value to the field width, then sign-extends signed fields
+static long long wrapField(long long value, const FieldSpec& f) {
+    unsigned long long mask = (1ULL << f.bits) - 1;
+    unsigned long long raw = (unsigned long long)value & mask;
+    if(f.isSigned && (raw >> (f.bits - 1)))
+        return (long long)(raw | ~mask);
+    return (long long)raw;
+}
+
+static int bitWidth(unsigned long long v) {
+    int bits = 0;
+    while(v)
+    {
+        bits++;
+        v >>= 1;
+    }
+    return bits;
+}
+
+unsigned short crc16(const unsigned char *data, size_t length) {
+    unsigned short crc = 0xFFFF;
+    for(size_t i = 0; i < length; i++)
+    {
+        crc ^= (unsigned short)(data[i] << 8);
+        for(int b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ 0x1021) : (unsigned short)(crc << 1);
+    }
+    return crc;
+}
+
+/* ************************************************************************* */
+TelemetryEncoder::TelemetryEncoder(unsigned int keyInterval)
+    : _keyInterval(keyInterval), _sequence(0)
+{
+    memset(_keys, 0, sizeof(_keys));
+}
+
+size_t TelemetryEncoder::encode(const TelemetryMessage& msg, unsigned char *out, size_t capacity) {
+    if(capacity < kMaxTelemetryFrameSize || msg.type >= TELEMETRY_TYPE_COUNT)
+        return 0;
+    const TypeSpec& spec = kTypes[msg.type];
+    KeyState& key = _keys[msg.type];
+
+    long long values[kMaxTelemetryFields];
+    int keyBits = 0;
+    for(int i = 0; i < spec.count; i++)
+    {
+        values[i] = wrapField(msg.values[i], spec.fields[i]);
+        keyBits += spec.fields[i].bits;
+    }
+
+    int width = 0;
+    if(key.valid && key.sinceKey < _keyInterval)
+    {
+        for(int i = 0; i < spec.count; i++)
+        {
+            int w = bitWidth(zigzagEncode(values[i] - key.values[i]));
+            if(w > width)
+                width = w;
+        }
+    }
+    bool isKey = !key.valid || key.sinceKey >= _keyInterval || width > kMaxDeltaBits ||
+                 8 + kDeltaWidthBits + width * spec.count >= keyBits;
+
+    BitWriter bits(out + kHeaderSize, capacity - kHeaderSize - kCrcSize);
+    if(isKey)
+    {
+        for(int i = 0; i < spec.count; i++)
+            bits.put((unsigned long long)values[i], spec.fields[i].bits);
+        key.valid = true;
+        key.sequence = _sequence;
+        key.sinceKey = 0;
+        memcpy(key.values, values, sizeof(values));
+    }
+    else
+    {
+        bits.put(key.sequence & 0xFF, 8);
+        bits.put(width, kDeltaWidthBits);
+        for(int i = 0; i < spec.count; i++)
+            bits.put(zigzagEncode(values[i] - key.values[i]), width);
+    }
+    key.sinceKey++;
+    size_t payload = bits.finish();
+
+    out[0] = kSync0;
+    out[1] = kSync1;
+    out[2] = (unsigned char)payload;
+    out[3] = (unsigned char)(_sequence & 0xFF);
+    out[4] = (unsigned char)(_sequence >> 8);
+    out[5] = (unsigned char)(msg.type | (isKey ? kKeyFlag : 0));
+    unsigned short crc = crc16(out + 2, kHeaderSize - 2 + payload);
+    out[kHeaderSize + payload] = (unsigned char)(crc & 0xFF);
+    out[kHeaderSize + payload + 1] = (unsigned char)(crc >> 8);
+    _sequence++;
+    return kHeaderSize + payload + kCrcSize;
+}
+
+/* ************************************************************************* */
+TelemetryDecoder::TelemetryDecoder()
+    : _length(0), _haveSequence(false), _nextSequence(0)
+{
+    memset(_keys, 0, sizeof(_keys));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void TelemetryDecoder::feed(const unsigned char *data, size_t length) {
+    size_t used = 0;
+    while(used < length)
+    {
+        size_t n = sizeof(_buffer) - _length;
+        if(n > length - used)
+            n = length - used;
+        memcpy(_buffer + _length, data + used, n);
+        _length += n;
+        used += n;
+
+        size_t pos = 0;
+        while(true)
+        {
+            // Find sync
+            while(pos + 1 < _length && !(_buffer[pos] == kSync0 && _buffer[pos + 1] == kSync1))
+                pos++;
+            if(pos + kHeaderSize > _length)
+                break;
+            size_t payload = _buffer[pos + 2];
+            size_t frameSize = kHeaderSize + payload + kCrcSize;
+            if(frameSize > kMaxTelemetryFrameSize)
+            {
+                pos++;
+                continue;
+            }
+            if(pos + frameSize > _length)
+                break;
+            const unsigned char *frame = _buffer + pos;
+            unsigned short crc = (unsigned short)(frame[kHeaderSize + payload] | (frame[kHeaderSize + payload + 1] << 8));
+            if(crc != crc16(frame + 2, kHeaderSize - 2 + payload))
+            {
+                _stats.crcErrors++;
+                pos++;
+                continue;
+            }
+            decodeFrame(frame, payload);
+            pos += frameSize;
+        }
+        memmove(_buffer, _buffer + pos, _length - pos);
+        _length -= pos;
+    }
+}
+
+void TelemetryDecoder::decodeFrame(const unsigned char *frame, size_t payloadLength) {
+    unsigned short sequence = (unsigned short)(frame[3] | (frame[4] << 8));
+    unsigned short gap = (unsigned short)(sequence - _nextSequence);
+    // A huge gap is really a repeat or a restarted sender
+    if(_haveSequence && gap < 0x8000)
+        _stats.lostFrames += gap;
+    _haveSequence = true;
+    _nextSequence = (unsigned short)(sequence + 1);
+    _stats.frames++;
+
+    int type = frame[5] & ~kKeyFlag;
+    if(type >= TELEMETRY_TYPE_COUNT)
+        return;
+    const TypeSpec& spec = kTypes[type];
+    KeyState& key = _keys[type];
+
+    TelemetryMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = (TelemetryType)type;
+    msg.sequence = sequence;
+    BitReader bits(frame + kHeaderSize, payloadLength);
+    if(frame[5] & kKeyFlag)
+    {
+        for(int i = 0; i < spec.count; i++)
+            msg.values[i] = wrapField((long long)bits.get(spec.fields[i].bits), spec.fields[i]);
+        if(bits.underflow())
+            return;
+        key.valid = true;
+        key.sequence = (unsigned char)(sequence & 0xFF);
+        memcpy(key.values, msg.values, sizeof(key.values));
+    }
+    else
+    {
+        unsigned char keySequence = (unsigned char)bits.get(8);
+        int width = (int)bits.get(kDeltaWidthBits);
+        if(!key.valid || key.sequence != keySequence)
+        {
+            _stats.missingKey++;
+            return;
+        }
+        for(int i = 0; i < spec.count; i++)
+            msg.values[i] = wrapField(key.values[i] + zigzagDecode(bits.get(width)), spec.fields[i]);
+        if(bits.underflow())
+            return;
+    }
+    onMessage(msg);
+}
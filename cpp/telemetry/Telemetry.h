@@ -0,0 +1,126 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stddef.h>
+#include <events/Event.hpp>
+#include "gps/NmeaParser.h"
+
+/**
+ * Kinds of downlink messages. Each is a short list of quantised integer fields.
+ */
+enum TelemetryType {
+    TELEMETRY_ATTITUDE = 0,     // time ms, roll, pitch, yaw (1e-4 rad)
+    TELEMETRY_GPS = 1,          // time ms, lat, lon (1e-7 deg), alt (dm), speed (cm/s), course (1e-2 deg), fix, satellites
+    TELEMETRY_CAMERA = 2,       // time ms, frames captured, frames dropped, keypoints in last frame
+    TELEMETRY_TYPE_COUNT
+};
+
+static const int kMaxTelemetryFields = 8;
+
+/**
+ * Largest frame the encoder produces, in bytes.
+ */
+static const size_t kMaxTelemetryFrameSize = 48;
+
+struct TelemetryMessage {
+    TelemetryType type;
+    unsigned short sequence;    // filled in by the decoder
+    long long values[kMaxTelemetryFields];
+};
+
+TelemetryMessage attitudeTelemetry(long long stamp, float roll, float pitch, float yaw);
+TelemetryMessage gpsTelemetry(const GpsFix& fix);
+TelemetryMessage cameraTelemetry(long long stamp, unsigned long long frames,
+                                 unsigned long long dropped, unsigned int keypoints);
+
+/**
+ * Number of fields, field names and the factor from quantised to SI/degree units.
+ */
+int telemetryFieldCount(TelemetryType type);
+const char *telemetryTypeName(TelemetryType type);
+const char *telemetryFieldName(TelemetryType type, int field);
+double telemetryFieldScale(TelemetryType type, int field);
+
+/**
+ * Builds downlink frames:
+ *   0xA5 0x5A, uint8 payload length, uint16 sequence, uint8 type (0x80 set on key frames),
+ *   bit-packed payload, CRC-16/CCITT over length..payload.
+ * A key frame carries every field at full width. A delta frame carries the low
+ * byte of the sequence number of its key frame and zigzag deltas against it,
+ * all at one shared bit width, so losing a delta frame never corrupts the next.
+ * A new key frame is sent every keyInterval messages of a type, or when a
+ * delta would not be smaller.
+ */
+class TelemetryEncoder {
+public:
+    TelemetryEncoder(unsigned int keyInterval = 10);
+
+    /**
+     * Encodes msg into out and advances the sequence number. Returns the frame
+     * size, or 0 if capacity is less than kMaxTelemetryFrameSize.
+     */
+    size_t encode(const TelemetryMessage& msg, unsigned char *out, size_t capacity);
+
+private:
+    struct KeyState {
+        bool valid;
+        unsigned short sequence;
+        unsigned int sinceKey;
+        long long values[kMaxTelemetryFields];
+    };
+
+    unsigned int _keyInterval;
+    unsigned short _sequence;
+    KeyState _keys[TELEMETRY_TYPE_COUNT];
+};
+
+struct TelemetryDecoderStats {
+    unsigned long long frames;
+    unsigned long long crcErrors;
+    unsigned long long lostFrames;      // from gaps in the sequence numbers
+    unsigned long long missingKey;      // deltas dropped because their key frame was lost
+};
+
+/**
+ * Reassembles frames from a byte stream, resynchronising on the sync bytes,
+ * and fires onMessage for every frame that decodes to a full message.
+ */
+class TelemetryDecoder {
+public:
+    TelemetryDecoder();
+
+    void feed(const unsigned char *data, size_t length);
+
+    const TelemetryDecoderStats& stats() const { return _stats; }
+
+    Event<const TelemetryMessage&> onMessage;
+
+private:
+    struct KeyState {
+        bool valid;
+        unsigned char sequence;
+        long long values[kMaxTelemetryFields];
+    };
+
+    unsigned char _buffer[2 * kMaxTelemetryFrameSize];
+    size_t _length;
+    bool _haveSequence;
+    unsigned short _nextSequence;
+    KeyState _keys[TELEMETRY_TYPE_COUNT];
+    TelemetryDecoderStats _stats;
+
+    void decodeFrame(const unsigned char *frame, size_t payloadLength);
+};
+
+/**
+ * CRC-16/CCITT-FALSE.
+ */
+unsigned short crc16(const unsigned char *data, size_t length);
+
+#endif /* TELEMETRY_H_ */
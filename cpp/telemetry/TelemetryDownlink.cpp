@@ -0,0 +1,78 @@
+/*
+ * TelemetryDownlink.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "TelemetryDownlink.h"
+#include <string.h>
+
+// Priority order of the types
+static const TelemetryType kPriority[TELEMETRY_TYPE_COUNT] = {
+    TELEMETRY_GPS, TELEMETRY_ATTITUDE, TELEMETRY_CAMERA
+};
+
+// Don't pile frames up behind a port that drains slower than the budget
+static const size_t kMaxQueuedFrames = 4;
+
+TelemetryDownlink::TelemetryDownlink(ASIOSerialPort& port, size_t bytesPerSecond)
+    : _port(port), _bytesPerNs(bytesPerSecond * 1e-9), _tokens(0),
+      _lastPoll(0), _started(false)
+{
+    // Allow half a second of burst, but always at least one frame
+    _burst = bytesPerSecond * 0.5;
+    if(_burst < kMaxTelemetryFrameSize)
+        _burst = kMaxTelemetryFrameSize;
+    memset(_channels, 0, sizeof(_channels));
+    memset(&_stats, 0, sizeof(_stats));
+    setPeriod(TELEMETRY_ATTITUDE, 0.1);
+    setPeriod(TELEMETRY_GPS, 1.0);
+    setPeriod(TELEMETRY_CAMERA, 2.0);
+}
+
+void TelemetryDownlink::setPeriod(TelemetryType type, double seconds) {
+    _channels[type].period = (long long)(seconds * 1e9);
+}
+
+void TelemetryDownlink::update(const TelemetryMessage& msg) {
+    _channels[msg.type].latest = msg;
+    _channels[msg.type].fresh = true;
+}
+
+void TelemetryDownlink::poll(long long now) {
+    if(!_started)
+    {
+        _lastPoll = now;
+        _tokens = _burst;
+        _started = true;
+    }
+    _tokens += (now - _lastPoll) * _bytesPerNs;
+    if(_tokens > _burst)
+        _tokens = _burst;
+    _lastPoll = now;
+
+    if(_port.writeQueueDepth() >= kMaxQueuedFrames)
+        return;
+
+    for(int p = 0; p < TELEMETRY_TYPE_COUNT; p++)
+    {
+        Channel& c = _channels[kPriority[p]];
+        if(!c.fresh || now < c.nextDue)
+            continue;
+        if(_tokens < kMaxTelemetryFrameSize)
+        {
+            _stats.overBudget++;
+            break;
+        }
+        size_t length = _encoder.encode(c.latest, _frame, sizeof(_frame));
+        _port.asyncWrite((const char *)_frame, length);
+        _tokens -= length;
+        _stats.framesSent++;
+        _stats.bytesSent += length;
+        c.fresh = false;
+        // Stay on the period grid unless we fell more than a period behind
+        c.nextDue += c.period;
+        if(c.nextDue <= now)
+            c.nextDue = now + c.period;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * TelemetryDownlink.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TELEMETRYDOWNLINK_H_
+#define TELEMETRYDOWNLINK_H_
+
+#include "serial/ASIOSerialPort.h"
+#include "Telemetry.h"
+
+struct TelemetryDownlinkStats {
+    unsigned long long framesSent;
+    unsigned long long bytesSent;
+    unsigned long long overBudget;      // due messages held back by the byte budget
+};
+
+/**
+ * Sends the latest value of each telemetry type over a serial radio without
+ * exceeding a byte rate budget.
+ *
+ * Each type has a period; when it is due and has a new value it is sent,
+ * highest priority (GPS, attitude, camera) first, as long as the token bucket
+ * holds enough bytes for a worst case frame. Only the newest value of a type
+ * is kept, so an exhausted budget never builds a backlog. Frames go out
+ * through ASIOSerialPort::asyncWrite(), so poll() never blocks.
+ */
+class TelemetryDownlink {
+public:
+    TelemetryDownlink(ASIOSerialPort& port, size_t bytesPerSecond);
+
+    /**
+     * Sets how often a type is sent, in seconds.
+     */
+    void setPeriod(TelemetryType type, double seconds);
+
+    /**
+     * Replaces the pending value of msg.type.
+     */
+    void update(const TelemetryMessage& msg);
+
+    /**
+     * Sends whatever is due. now is in nanoseconds on any monotonic clock.
+     */
+    void poll(long long now);
+
+    const TelemetryDownlinkStats& stats() const { return _stats; }
+
+private:
+    struct Channel {
+        TelemetryMessage latest;
+        bool fresh;
+        long long period;
+        long long nextDue;
+    };
+
+    ASIOSerialPort& _port;
+    TelemetryEncoder _encoder;
+    double _bytesPerNs;
+    double _tokens;
+    double _burst;
+    long long _lastPoll;
+    bool _started;
+    Channel _channels[TELEMETRY_TYPE_COUNT];
+    unsigned char _frame[kMaxTelemetryFrameSize];
+    TelemetryDownlinkStats _stats;
+};
+
+#endif /* TELEMETRYDOWNLINK_H_ */
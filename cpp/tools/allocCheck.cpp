@@ -0,0 +1,527 @@
+/*
+ * allocCheck.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Replays synthetic IMU and GPS traffic over pseudo terminals through the
+ * bbLog pipeline (serial framing, parsing, alignment, estimation, GPS clock
+ * model, log, checksum and telemetry encoding) and counts heap allocations after a warm-up period.
+ * Exits with 1 if anything allocated, so it can gate changes to the hot path.
+ *
+ * The IMU path is checked on the way. Before the replay, IMU line parsing,
+ * ImuFrameAligner (interpolation at the frame stamp, ring wrap-around,
+ * block contents) and the attitude estimator on a stream whose reader
+ * stalls for 100 ms are checked on synthetic input; in the replay, where
+ * the IMU sends bursts of lines, no sample may be lost by the estimator.
+ * Exits with 3 if any of that fails.
+ *
+ * Usage: allocCheck [seconds] [/file/to/logdir/]
+ */
+
+#include <iostream>
+#include <fcntl.h>
+#include <math.h>
+#include <pty.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+#include "serial/ASIOSerialPort.h"
+#include "imu/ImuSample.h"
+#include "imu/ImuFrameAligner.h"
+#include "imu/AttitudeEstimator.h"
+#include "gps/NmeaParser.h"
+#include "gps/GpsClock.h"
+#include "log/LogWriter.h"
+#include "log/ChecksumManifest.h"
+#include "telemetry/TelemetryDownlink.h"
+#include "util/AllocCounter.h"
+
+/* ************************************************************************* */
+// Opens a raw pty pair, returns the master fd and the slave device name
+int OpenPty(char *name){
+  int master, slave;
+  if(openpty(&master, &slave, name, 0, 0) < 0)
+    return -1;
+  struct termios t;
+  tcgetattr(slave, &t);
+  cfmakeraw(&t);
+  tcsetattr(slave, TCSANOW, &t);
+  fcntl(master, F_SETFL, O_NONBLOCK);
+  return master;
+}
+
+/* ************************************************************************* */
+bool Report(const char *check, bool ok, const std::string& detail = ""){
+  std::cout << (ok ? "ok   " : "FAIL ") << check;
+  if(!ok && !detail.empty())
+    std::cout << ": " << detail;
+  std::cout << std::endl;
+  return ok;
+}
+
+/* ************************************************************************* */
+bool Near(float a, float b, float tolerance = 1e-4f){
+  return fabs(a - b) <= tolerance;
+}
+
+/* ************************************************************************* */
+// Fields, values, exponents and lines that are not IMU records
+bool CheckImuParsing(){
+  bool ok = true;
+  std::string detail;
+  ImuSample sample;
+  const char *full = "!ANG:1.5,-2.25,179.9,AN:-8,3,-2,5,-7,255,100,-40,300";
+  if(!parseImuLine(full, strlen(full), sample) ||
+     sample.fields != (IMU_HAS_EULER | IMU_HAS_GYRO | IMU_HAS_ACCEL | IMU_HAS_MAG) ||
+     !Near(sample.euler[0], 1.5f) || !Near(sample.euler[1], -2.25f) || !Near(sample.euler[2], 179.9f) ||
+     !Near(sample.gyro[0], -8) || !Near(sample.accel[2], 255) || !Near(sample.mag[2], 300)){
+    ok = false;
+    detail += " full line;";
+  }
+  const char *euler = "!ANG:0.5,0,-0.5";
+  if(!parseImuLine(euler, strlen(euler), sample) || sample.fields != IMU_HAS_EULER){
+    ok = false;
+    detail += " euler only;";
+  }
+  // Exponents, including one long enough to overflow an int
+  const char *exponents = "!ANG:1e2,-3E-1,+2.5e+1,AN:1e-99999999999999,4e0,1.5e3";
+  if(!parseImuLine(exponents, strlen(exponents), sample) || !Near(sample.euler[0], 100) ||
+     !Near(sample.euler[1], -0.3f) || !Near(sample.euler[2], 25) || sample.gyro[0] != 0 ||
+     !Near(sample.gyro[1], 4) || !Near(sample.gyro[2], 1500)){
+    ok = false;
+    detail += " exponents;";
+  }
+  const char *huge = "!ANG:1e99999999999999,0,0";
+  if(!parseImuLine(huge, strlen(huge), sample) || !isinf(sample.euler[0])){
+    ok = false;
+    detail += " huge exponent;";
+  }
+  const char *others[] = { "$GPGGA,123519,4807.038,N", "!ANG:1,2", "ANG:1,2,3", "" };
+  for(size_t i = 0; i < sizeof(others) / sizeof(others[0]); i++){
+    if(parseImuLine(others[i], strlen(others[i]), sample)){
+      ok = false;
+      detail += std::string(" accepted \"") + others[i] + "\";";
+    }
+  }
+  return Report("IMU line parsing", ok, detail);
+}
+
+/* ************************************************************************* */
+// Copies of the blocks an aligner emits
+class BlockCollector{
+public:
+  BlockCollector() : Lcollect(this) {}
+
+  void collect(const ImuFrameBlock& block){
+    blocks.push_back(block);
+    samples.push_back(std::vector<ImuSample>(block.samples, block.samples + block.count));
+  }
+  LISTENER(BlockCollector, collect, const ImuFrameBlock&);
+
+  std::vector<ImuFrameBlock> blocks;
+  std::vector<std::vector<ImuSample> > samples;
+};
+
+/* ************************************************************************* */
+ImuSample AlignerSample(int i){
+  const long long k_start = 1000000000LL;
+  const long long k_period = 10000000;
+  ImuSample sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.stamp = k_start + i * k_period;
+  sample.fields = IMU_HAS_EULER | IMU_HAS_GYRO;
+  sample.euler[0] = (float)i;
+  // Yaw crosses +-180 between samples 4 and 5
+  sample.euler[2] = i < 5 ? 170.f : -170.f;
+  sample.gyro[0] = 10.f * i;
+  return sample;
+}
+
+/* ************************************************************************* */
+// Interpolation at the frame stamp, the samples of each block, and a ring
+// that wraps around before a frame comes
+bool CheckFrameAligner(){
+  bool ok = true;
+  char detail[256] = "";
+  const long long k_halfPeriod = 5000000;
+
+  ImuFrameAligner aligner(8);
+  BlockCollector collector;
+  aligner.onFrameBlock += &collector.Lcollect;
+  for(int i = 0; i < 5; i++)
+    aligner.addSample(AlignerSample(i));
+  // Halfway between samples 4 and 5, emitted once sample 5 arrives
+  long long frame1 = AlignerSample(4).stamp + k_halfPeriod;
+  aligner.addFrame(frame1);
+  bool heldBack = collector.blocks.empty();
+  aligner.addSample(AlignerSample(5));
+  if(!heldBack || collector.blocks.size() != 1){
+    snprintf(detail, sizeof(detail), "first frame %s", heldBack ? "never emitted" : "not held back");
+    return Report("frame aligner", false, detail);
+  }
+  const ImuFrameBlock& first = collector.blocks[0];
+  const std::vector<ImuSample>& firstSamples = collector.samples[0];
+  if(first.flags != IMU_BLOCK_INTERPOLATED || first.atFrame.stamp != frame1 ||
+     !Near(first.atFrame.euler[0], 4.5f) || !Near(first.atFrame.gyro[0], 45.f) ||
+     !Near(fabs(first.atFrame.euler[2]), 180.f, 1e-3f) || firstSamples.size() != 5 ||
+     firstSamples[0].stamp != AlignerSample(0).stamp || firstSamples[4].stamp != AlignerSample(4).stamp){
+    snprintf(detail, sizeof(detail), "first block: flags %d, %d samples, roll %.3f, gyro %.3f, yaw %.3f",
+             first.flags, (int)firstSamples.size(), first.atFrame.euler[0], first.atFrame.gyro[0],
+             first.atFrame.euler[2]);
+    ok = false;
+  }
+
+  // 15 more samples overflow the ring of 8; the frame before the last one
+  // keeps what is left of its interval and says so
+  for(int i = 6; i < 21; i++)
+    aligner.addSample(AlignerSample(i));
+  long long frame2 = AlignerSample(19).stamp + k_halfPeriod;
+  aligner.addFrame(frame2);
+  if(ok && collector.blocks.size() != 2){
+    snprintf(detail, sizeof(detail), "second frame not emitted with the IMU already past it");
+    ok = false;
+  }
+  else if(ok){
+    const ImuFrameBlock& second = collector.blocks[1];
+    const std::vector<ImuSample>& secondSamples = collector.samples[1];
+    bool ascending = true;
+    for(size_t i = 1; i < secondSamples.size(); i++)
+      ascending = ascending && secondSamples[i].stamp == secondSamples[i - 1].stamp + 2 * k_halfPeriod;
+    if(second.flags != (IMU_BLOCK_INTERPOLATED | IMU_BLOCK_TRUNCATED) || !Near(second.atFrame.euler[0], 19.5f) ||
+       secondSamples.size() != 7 || secondSamples[0].stamp != AlignerSample(13).stamp || !ascending){
+      snprintf(detail, sizeof(detail), "wrapped block: flags %d, %d samples from %.0f, roll %.3f",
+               second.flags, (int)secondSamples.size(),
+               secondSamples.empty() ? -1.0 : secondSamples[0].euler[0], second.atFrame.euler[0]);
+      ok = false;
+    }
+  }
+
+  // Encoded length matches the documented layout: header, then each sample
+  // with euler and gyro
+  if(ok){
+    std::vector<char> buffer(maxEncodedImuFrameBlockSize(8));
+    ImuFrameBlock block = collector.blocks[1];
+    block.samples = &collector.samples[1][0];
+    size_t length = encodeImuFrameBlock(block, &buffer[0], buffer.size());
+    size_t expected = 15 + (1 + 7) * (5 + 24);
+    unsigned int stored = (unsigned char)buffer[0] | (unsigned char)buffer[1] << 8 |
+                          (unsigned char)buffer[2] << 16 | (unsigned int)(unsigned char)buffer[3] << 24;
+    if(length != expected || stored != length){
+      snprintf(detail, sizeof(detail), "encoded %d bytes, length field %u, expected %d",
+               (int)length, stored, (int)expected);
+      ok = false;
+    }
+  }
+  return Report("frame aligner", ok, detail);
+}
+
+/* ************************************************************************* */
+// A 50 Hz turn at a constant rate whose reader stalls for 100 ms: the five
+// samples of the stall arrive stamped together with the one after it.
+// Every sample must be integrated, over the time the stream covers
+bool CheckEstimatorStall(){
+  const double k_rate = 50;
+  const long long k_period = 20000000;
+  const int k_samples = 500;
+  const int k_stallAt = 250;
+  const int k_stallSamples = 5;
+  ImuCalibration calibration;
+  AttitudeEstimator estimator(calibration, 0, 0);
+  estimator.setNominalRate(k_rate);
+  ImuSample sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.fields = IMU_HAS_GYRO;
+  sample.gyro[2] = 100;
+  for(int i = 0; i < k_samples; i++){
+    int arrival = (i >= k_stallAt && i < k_stallAt + k_stallSamples) ? k_stallAt + k_stallSamples : i;
+    sample.stamp = 1000000000LL + arrival * k_period;
+    estimator.update(sample);
+  }
+  const ImuPreintegration& preint = estimator.preintegration();
+  double covered = (k_samples - 1) * k_period * 1e-9;
+  float roll, pitch, yaw;
+  estimator.eulerAngles(roll, pitch, yaw);
+  double expectedYaw = sample.gyro[2] * calibration.gyroScale * covered;
+  char detail[160];
+  snprintf(detail, sizeof(detail), "%u of %d samples integrated over %.4f s, yaw %.4f, expected %.4f",
+           preint.count, k_samples - 1, preint.deltaT, yaw, expectedYaw);
+  return Report("estimator over a 100 ms stall",
+                preint.count == (unsigned int)(k_samples - 1) && fabs(preint.deltaT - covered) < 1e-6 &&
+                fabs(yaw - expectedYaw) < 1e-3, detail);
+}
+
+/* ************************************************************************* */
+// Feeds the "sensors" and drains the radio, without allocating
+class TrafficGenerator{
+public:
+  TrafficGenerator(int imu, int gps, int radio)
+    : _imu(imu), _gps(gps), _radio(radio), _running(true) {}
+
+  void run(){
+    char line[160];
+    char sink[256];
+    for(unsigned int i = 0; _running; i++){
+      int n = snprintf(line, sizeof(line), "!ANG:%.2f,%.2f,%.2f,AN:%d,%d,%d,%d,%d,%d,%d,%d,%d\r\n",
+                       0.01 * (i % 300), -1.5, 0.1 * (i % 3600) - 180.0,
+                       (int)(i % 17) - 8, 3, -2, 5, -7, 255, 100, -40, 300);
+      ::write(_imu, line, n);
+      // Every 500 lines the next 50 go out at once, as after a stall
+      bool burst = i % 500 >= 450;
+      if(i % 50 == 0){
+        static const char k_gga[] = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+        ::write(_gps, k_gga, sizeof(k_gga) - 1);
+        // Same time every epoch; the clock model sees a step and starts over
+        static const char k_rmc[] = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,191026,003.1,W*68\r\n";
+        ::write(_gps, k_rmc, sizeof(k_rmc) - 1);
+      }
+      while(read(_radio, sink, sizeof(sink)) > 0){}
+      if(!burst)
+        usleep(2000);
+    }
+  }
+
+  void stop(){ _running = false; }
+
+private:
+  int _imu, _gps, _radio;
+  volatile bool _running;
+};
+
+/* ************************************************************************* */
+// GPS path through the event thread
+class GpsLogger{
+public:
+  GpsLogger(LogWriter& log, TelemetryDownlink& downlink, GpsClock& clock)
+    : LhandleLine(this), _log(log), _downlink(downlink), _clock(clock), _fix(emptyGpsFix()), _lines(0) {}
+
+  void handleLine(const SerialLine& line){
+    if(line.length == 0)
+      return;
+    timespec now;
+    now.tv_sec = line.stamp / 1000000000LL;
+    now.tv_nsec = line.stamp % 1000000000LL;
+    boost::mutex::scoped_lock lock(_lock);
+    unsigned char updated = parseNmeaLine(line.data, line.length, _fix);
+    long long utc;
+    if((updated & GPS_HAS_DATE) && gpsFixUtc(_fix, utc))
+      _clock.add(utc, toNanoseconds(now));
+    _log.write("gps", now, _clock.toUtc(toNanoseconds(now)), line.data, line.length);
+    if(updated){
+      _fix.stamp = toNanoseconds(now);
+      _downlink.update(gpsTelemetry(_fix));
+    }
+    _lines++;
+  }
+  LISTENER(GpsLogger, handleLine, const SerialLine&);
+
+  boost::mutex _lock;
+
+private:
+  LogWriter& _log;
+  TelemetryDownlink& _downlink;
+  GpsClock& _clock;
+  GpsFix _fix;
+  unsigned long long _lines;
+};
+
+/* ************************************************************************* */
+// IMU path through the event thread, like bbLog's ImuLineLogger; frames
+// are taken under the same lock
+class ImuLogger{
+public:
+  ImuLogger(LogWriter& log, GpsClock& clock, ImuFrameAligner& aligner, AttitudeEstimator& estimator)
+    : LhandleLine(this), _log(log), _clock(clock), _aligner(aligner), _estimator(estimator),
+      _lines(0), _gyroSamples(0), _integrated(0) {}
+
+  void handleLine(const SerialLine& line){
+    ImuSample sample;
+    if(line.length == 0 || line.data[0] != '!' || !parseImuLine(line.data, line.length, sample))
+      return;
+    timespec arrival;
+    arrival.tv_sec = line.stamp / 1000000000LL;
+    arrival.tv_nsec = line.stamp % 1000000000LL;
+    _log.write("imu", arrival, _clock.toUtc(line.stamp), line.data, line.length);
+    sample.stamp = line.stamp;
+    boost::mutex::scoped_lock lock(_lock);
+    _aligner.addSample(sample);
+    _estimator.update(sample);
+    _lines++;
+    if(sample.fields & IMU_HAS_GYRO)
+      _gyroSamples++;
+  }
+  LISTENER(ImuLogger, handleLine, const SerialLine&);
+
+  void frame(long long stamp, float *att, float *preint){
+    boost::mutex::scoped_lock lock(_lock);
+    _aligner.addFrame(stamp);
+    _estimator.eulerAngles(att[0], att[1], att[2]);
+    flattenPreintegration(_estimator.preintegration(), preint);
+    _integrated += _estimator.preintegration().count;
+    _estimator.resetPreintegration();
+  }
+
+  unsigned long long lines(){
+    boost::mutex::scoped_lock lock(_lock);
+    return _lines;
+  }
+
+  // Gyro samples left out of the estimate; the first only starts it
+  long long lost(){
+    boost::mutex::scoped_lock lock(_lock);
+    return (long long)_gyroSamples - 1 - (long long)(_integrated + _estimator.preintegration().count);
+  }
+
+private:
+  LogWriter& _log;
+  GpsClock& _clock;
+  ImuFrameAligner& _aligner;
+  AttitudeEstimator& _estimator;
+  boost::mutex _lock;
+  unsigned long long _lines;
+  unsigned long long _gyroSamples;
+  unsigned long long _integrated;
+};
+
+/* ************************************************************************* */
+class FrameBlockSink{
+public:
+  FrameBlockSink(FILE *out, size_t maxSamples)
+    : Lwrite(this), _out(out), _buffer(maxEncodedImuFrameBlockSize(maxSamples)) {}
+
+  void write(const ImuFrameBlock& block){
+    size_t length = encodeImuFrameBlock(block, &_buffer[0], _buffer.size());
+    fwrite(&_buffer[0], 1, length, _out);
+  }
+  LISTENER(FrameBlockSink, write, const ImuFrameBlock&);
+
+private:
+  FILE *_out;
+  std::vector<char> _buffer;
+};
+
+/* ************************************************************************* */
+int main(int argc, char *argv[]){
+  int seconds = argc > 1 ? atoi(argv[1]) : 5;
+  std::string logDir = argc > 2 ? argv[2] : "/tmp/";
+  const int k_warmupSeconds = 1;
+  bool imuOk = CheckImuParsing();
+  imuOk = CheckFrameAligner() && imuOk;
+  imuOk = CheckEstimatorStall() && imuOk;
+
+  char imuName[64], gpsName[64], radioName[64];
+  int imuMaster = OpenPty(imuName);
+  int gpsMaster = OpenPty(gpsName);
+  int radioMaster = OpenPty(radioName);
+  if(imuMaster < 0 || gpsMaster < 0 || radioMaster < 0){
+    std::cerr << "Failed to open pseudo terminals" << std::endl;
+    return 2;
+  }
+
+  ASIOSerialPort imu(imuName, 57600);
+  ASIOSerialPort gps(gpsName, 38400);
+  ASIOSerialPort radio(radioName, 57600);
+
+  LogWriter logFile;
+  std::string logPath = logDir + "allocCheck-log.txt";
+  std::string blockPath = logDir + "allocCheck-frame_imu.bin";
+  if(!logFile.open(logPath.c_str()))
+    return 2;
+  FILE *blockFile = fopen(blockPath.c_str(), "wb");
+  ChecksumManifest checksums;
+  checksums.open((logDir + "allocCheck-checksums.txt").c_str());
+  logFile.setChecksums(&checksums, "allocCheck-log.txt");
+
+  // Every frame reads back the same stand-in image, like bbLog does its frames
+  std::string imgPath = logDir + "allocCheck-image.pgm";
+  {
+    std::vector<char> img(640 * 480 + 64, 100);
+    int fd = ::open(imgPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0 || ::write(fd, &img[0], img.size()) != (ssize_t)img.size())
+      return 2;
+    ::close(fd);
+  }
+
+  const size_t k_imuRingSize = 512;
+  ImuFrameAligner aligner(k_imuRingSize);
+  FrameBlockSink blockSink(blockFile, k_imuRingSize);
+  aligner.onFrameBlock += &blockSink.Lwrite;
+  // The generator sends a line about every 2 ms
+  AttitudeEstimator estimator;
+  estimator.setNominalRate(500);
+  TelemetryDownlink downlink(radio, 2000);
+
+  GpsClock gpsClock;
+  GpsLogger gpsLogger(logFile, downlink, gpsClock);
+  gps.onLineData += &gpsLogger.LhandleLine;
+  gps.startEvents();
+
+  ImuLogger imuLogger(logFile, gpsClock, aligner, estimator);
+  imu.onLineData += &imuLogger.LhandleLine;
+  imu.startEvents();
+
+  TrafficGenerator traffic(imuMaster, gpsMaster, radioMaster);
+  boost::thread trafficThread(boost::bind(&TrafficGenerator::run, &traffic));
+
+  // Same shape as the bbLog main loop, a frame every 40 ms
+  const long long k_framePeriod = 40000000;
+  unsigned long long frames = 0;
+  timespec start, now;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  long long nextFrame = toNanoseconds(start);
+  bool armed = false;
+  while(true){
+    usleep(2000);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+    if(!armed && elapsed >= k_warmupSeconds){
+      AllocCounter::arm();
+      armed = true;
+    }
+    if(elapsed >= k_warmupSeconds + seconds)
+      break;
+
+    if(toNanoseconds(now) >= nextFrame){
+      nextFrame += k_framePeriod;
+      checksums.queueFile(imgPath.c_str(), "allocCheck-image.pgm");
+      float att[3], preint[kPreintegrationValues];
+      imuLogger.frame(toNanoseconds(now), att, preint);
+      logFile.writeValues("att", now, att, 3);
+      logFile.writeValues("pre", now, preint, kPreintegrationValues);
+      boost::mutex::scoped_lock lock(gpsLogger._lock);
+      downlink.update(attitudeTelemetry(toNanoseconds(now), att[0], att[1], att[2]));
+      downlink.update(cameraTelemetry(toNanoseconds(now), ++frames, 0, 0));
+    }
+    boost::mutex::scoped_lock lock(gpsLogger._lock);
+    downlink.poll(toNanoseconds(now));
+  }
+  AllocCounter::disarm();
+
+  traffic.stop();
+  trafficThread.join();
+  gps.stopEvents();
+  imu.stopEvents();
+  fclose(blockFile);
+  logFile.close();
+  checksums.close();
+
+  unsigned long long imuLines = imuLogger.lines();
+  long long lost = imuLogger.lost();
+  std::cout << "imu lines: " << imuLines << ", frames: " << frames
+            << ", telemetry frames: " << downlink.stats().framesSent << std::endl;
+  std::cout << "allocations after warm-up: " << AllocCounter::count()
+            << " (" << AllocCounter::bytes() << " bytes)" << std::endl;
+  if(imuLines == 0){
+    std::cerr << "no IMU traffic got through" << std::endl;
+    return 2;
+  }
+  char detail[64];
+  snprintf(detail, sizeof(detail), "%lld of %llu lines", lost, imuLines);
+  bool replayOk = Report("no IMU sample lost in the replay", lost == 0, detail);
+  if(!imuOk || !replayOk)
+    return 3;
+  return AllocCounter::count() == 0 ? 0 : 1;
+}
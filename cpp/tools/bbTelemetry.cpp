@@ -0,0 +1,70 @@
+/*
+ * bbTelemetry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Ground side of the telemetry downlink: decodes frames from a serial radio
+ * and prints one line per message, plus link statistics every few seconds.
+ * For a bench test, run bbLog with --telemetry on one end of a pty pair
+ * (eg. socat -d -d pty,raw,echo=0 pty,raw,echo=0) and this on the other.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <time.h>
+
+#include "serial/ASIOSerialPort.h"
+#include "telemetry/Telemetry.h"
+
+/* ************************************************************************* */
+class MessagePrinter{
+public:
+  MessagePrinter() : Lprint(this) {}
+
+  void print(const TelemetryMessage& msg){
+    std::cout << telemetryTypeName(msg.type) << " seq=" << msg.sequence;
+    for(int i = 0; i < telemetryFieldCount(msg.type); i++){
+      std::cout << " " << telemetryFieldName(msg.type, i) << "="
+                << std::setprecision(10) << msg.values[i] * telemetryFieldScale(msg.type, i);
+    }
+    std::cout << std::endl;
+  }
+
+  LISTENER(MessagePrinter, print, const TelemetryMessage&);
+};
+
+/* ************************************************************************* */
+int main(int argc, char *argv[]){
+  if(argc < 2){
+    std::cout << "Usage: bbTelemetry /dev/ttyUSB0 [baud]" << std::endl;
+    return -1;
+  }
+  size_t baud = argc > 2 ? atoi(argv[2]) : 57600;
+  ASIOSerialPort radio(argv[1], baud);
+
+  TelemetryDecoder decoder;
+  MessagePrinter printer;
+  decoder.onMessage += &printer.Lprint;
+
+  const int k_statsPeriod = 5; // seconds
+  time_t lastStats = time(0);
+  char buffer[256];
+  while(true){
+    size_t numRead;
+    ReadStatus status = radio.readSome(buffer, sizeof(buffer), numRead, 1000);
+    if(status == READ_ERROR){
+      std::cerr << "Radio read failed" << std::endl;
+      return -1;
+    }
+    decoder.feed((const unsigned char*)buffer, numRead);
+
+    if(time(0) - lastStats >= k_statsPeriod){
+      const TelemetryDecoderStats& s = decoder.stats();
+      std::cout << "link frames=" << s.frames << " lost=" << s.lostFrames
+                << " crc_errors=" << s.crcErrors << " missing_key=" << s.missingKey << std::endl;
+      lastStats = time(0);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,575 @@
+/*
+ * logExport.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Converts the log.txt of a bbLog recording into one column file per
+ * sensor (see log/ColumnFile.h), so analysis tools can map a channel
+ * instead of re-parsing the interleaved text:
+ *   imu.col : stamp, utc_stamp, roll, pitch, yaw, gyro_x..z, accel_x..z, mag_x..z, fields
+ *   gps.col : stamp, utc_stamp, lat, lon, alt, speed, course, utc, fix, satellites, fields
+ *   att.col : stamp, roll, pitch, yaw
+ *   jit.col : stamp, deviation_ms
+ * Values a record does not carry are NaN; utc_stamp (UTC nanoseconds of the
+ * record from the GPS clock model) is -1 before the model is locked. GPS
+ * rows hold what their own sentence carries, so GGA and RMC rows complement
+ * each other.
+ *
+ * The log is cut into segments that worker threads parse in parallel; the
+ * main thread appends the parsed segments in log order. Only a few segments
+ * are in memory at once, so logs larger than RAM stream through.
+ *
+ * --verify parses the log a second time and compares it with the column
+ * files as ColumnFileReader maps them: row counts, every value (bit for
+ * bit, so NaNs compare equal) and the min/max of every chunk.
+ *
+ * Usage: logExport /file/to/logdir/ [/file/to/outdir/] [--threads=N] [--chunk-rows=N] [--verify]
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "imu/ImuSample.h"
+#include "gps/NmeaParser.h"
+#include "log/LogWriter.h"
+#include "log/ColumnFile.h"
+
+enum Table { TABLE_IMU, TABLE_GPS, TABLE_ATT, TABLE_JIT, TABLE_COUNT };
+
+static const char *k_tableTags[TABLE_COUNT] = { "imu", "gps", "att", "jit" };
+
+static const ColumnSpec k_imuColumns[] = {
+  { "stamp", COLUMN_INT64 }, { "utc_stamp", COLUMN_INT64 },
+  { "roll", COLUMN_FLOAT32 }, { "pitch", COLUMN_FLOAT32 }, { "yaw", COLUMN_FLOAT32 },
+  { "gyro_x", COLUMN_FLOAT32 }, { "gyro_y", COLUMN_FLOAT32 }, { "gyro_z", COLUMN_FLOAT32 },
+  { "accel_x", COLUMN_FLOAT32 }, { "accel_y", COLUMN_FLOAT32 }, { "accel_z", COLUMN_FLOAT32 },
+  { "mag_x", COLUMN_FLOAT32 }, { "mag_y", COLUMN_FLOAT32 }, { "mag_z", COLUMN_FLOAT32 },
+  { "fields", COLUMN_UINT8 }
+};
+static const ColumnSpec k_gpsColumns[] = {
+  { "stamp", COLUMN_INT64 }, { "utc_stamp", COLUMN_INT64 },
+  { "lat", COLUMN_FLOAT64 }, { "lon", COLUMN_FLOAT64 }, { "alt", COLUMN_FLOAT32 },
+  { "speed", COLUMN_FLOAT32 }, { "course", COLUMN_FLOAT32 }, { "utc", COLUMN_FLOAT64 },
+  { "fix", COLUMN_UINT8 }, { "satellites", COLUMN_UINT8 }, { "fields", COLUMN_UINT8 }
+};
+static const ColumnSpec k_attColumns[] = {
+  { "stamp", COLUMN_INT64 },
+  { "roll", COLUMN_FLOAT32 }, { "pitch", COLUMN_FLOAT32 }, { "yaw", COLUMN_FLOAT32 }
+};
+static const ColumnSpec k_jitColumns[] = {
+  { "stamp", COLUMN_INT64 },
+  { "deviation_ms", COLUMN_FLOAT32 }
+};
+
+static const ColumnSpec *k_tableColumns[TABLE_COUNT] = {
+  k_imuColumns, k_gpsColumns, k_attColumns, k_jitColumns
+};
+static const int k_tableColumnCounts[TABLE_COUNT] = {
+  sizeof(k_imuColumns) / sizeof(ColumnSpec), sizeof(k_gpsColumns) / sizeof(ColumnSpec),
+  sizeof(k_attColumns) / sizeof(ColumnSpec), sizeof(k_jitColumns) / sizeof(ColumnSpec)
+};
+
+/* ************************************************************************* */
+void PrintUsage(){
+  std::cout << "Usage: logExport /file/to/logdir/ [/file/to/outdir/] [options]" << std::endl
+            << "  --threads=N      parser threads (default: all cores)" << std::endl
+            << "  --chunk-rows=N   rows per chunk of the column files (default 65536)" << std::endl
+            << "  --verify         read the column files back and compare them with the log" << std::endl;
+}
+
+/* ************************************************************************* */
+// Pushes count floats, or NaNs when the record did not carry them
+void PushFloats(ColumnBatch& batch, int& column, const float *values, int count, bool present){
+  for(int i = 0; i < count; i++)
+    batch.push(column++, present ? values[i] : NAN);
+}
+
+/* ************************************************************************* */
+// Parses up to count whitespace separated floats of text; the rest are NaN
+void ParseFloats(const char *text, size_t length, float *values, int count){
+  char buffer[128];
+  size_t n = length < sizeof(buffer) - 1 ? length : sizeof(buffer) - 1;
+  memcpy(buffer, text, n);
+  buffer[n] = '\0';
+  char *p = buffer;
+  for(int i = 0; i < count; i++){
+    char *end;
+    values[i] = strtof(p, &end);
+    if(end == p){
+      for(; i < count; i++)
+        values[i] = NAN;
+      return;
+    }
+    p = end;
+  }
+}
+
+/* ************************************************************************* */
+// Rows of one segment of the log, per table
+struct Segment{
+  Segment() : records(0), skipped(0){
+    for(int t = 0; t < TABLE_COUNT; t++)
+      batches[t].reset(new ColumnBatch(k_tableColumns[t], k_tableColumnCounts[t]));
+  }
+
+  void clear(){
+    for(int t = 0; t < TABLE_COUNT; t++)
+      batches[t]->clear();
+    records = 0;
+    skipped = 0;
+  }
+
+  void add(const LogRecord& record){
+    int table = 0;
+    while(table < TABLE_COUNT &&
+          (strlen(k_tableTags[table]) != record.tagLength ||
+           memcmp(k_tableTags[table], record.tag, record.tagLength) != 0))
+      table++;
+    if(table == TABLE_COUNT){
+      skipped++;
+      return;
+    }
+    ColumnBatch& batch = *batches[table];
+    int column = 0;
+    switch(table){
+    case TABLE_IMU:{
+      ImuSample sample;
+      if(!parseImuLine(record.text, record.textLength, sample)){
+        skipped++;
+        return;
+      }
+      batch.push(column++, record.stamp);
+      batch.push(column++, record.utc);
+      PushFloats(batch, column, sample.euler, 3, sample.fields & IMU_HAS_EULER);
+      PushFloats(batch, column, sample.gyro, 3, sample.fields & IMU_HAS_GYRO);
+      PushFloats(batch, column, sample.accel, 3, sample.fields & IMU_HAS_ACCEL);
+      PushFloats(batch, column, sample.mag, 3, sample.fields & IMU_HAS_MAG);
+      batch.push(column++, sample.fields);
+      break;
+    }
+    case TABLE_GPS:{
+      GpsFix fix = emptyGpsFix();
+      if(!parseNmeaLine(record.text, record.textLength, fix)){
+        skipped++;
+        return;
+      }
+      bool position = fix.fields & GPS_HAS_POSITION;
+      bool velocity = fix.fields & GPS_HAS_VELOCITY;
+      batch.push(column++, record.stamp);
+      batch.push(column++, record.utc);
+      batch.push(column++, position ? fix.latitude : NAN);
+      batch.push(column++, position ? fix.longitude : NAN);
+      batch.push(column++, (fix.fields & GPS_HAS_ALTITUDE) ? fix.altitude : NAN);
+      batch.push(column++, velocity ? fix.speed : NAN);
+      batch.push(column++, velocity ? fix.course : NAN);
+      batch.push(column++, (fix.fields & GPS_HAS_TIME) ? fix.utcSeconds : NAN);
+      batch.push(column++, fix.fixQuality);
+      batch.push(column++, fix.satellites);
+      batch.push(column++, fix.fields);
+      break;
+    }
+    case TABLE_ATT:{
+      float rpy[3];
+      ParseFloats(record.text, record.textLength, rpy, 3);
+      batch.push(column++, record.stamp);
+      PushFloats(batch, column, rpy, 3, true);
+      break;
+    }
+    case TABLE_JIT:{
+      float deviation;
+      ParseFloats(record.text, record.textLength, &deviation, 1);
+      batch.push(column++, record.stamp);
+      batch.push(column++, deviation);
+      break;
+    }
+    }
+    records++;
+  }
+
+  boost::scoped_ptr<ColumnBatch> batches[TABLE_COUNT];
+  unsigned long long records;
+  unsigned long long skipped;
+};
+
+/* ************************************************************************* */
+// Parses segments on worker threads and hands them back in log order
+class SegmentPipeline{
+public:
+  SegmentPipeline(int fd, unsigned long long fileSize, size_t segmentSize, int threads)
+    : _fd(fd), _fileSize(fileSize), _segmentSize(segmentSize),
+      _segmentCount((fileSize + segmentSize - 1) / segmentSize),
+      _slots(2 * threads), _nextToParse(0), _nextToWrite(0), _failed(false)
+  {
+    for(size_t i = 0; i < _slots.size(); i++)
+      _slots[i].reset(new Slot());
+    for(int i = 0; i < threads; i++)
+      _threads.create_thread(boost::bind(&SegmentPipeline::work, this));
+  }
+
+  ~SegmentPipeline(){
+    _threads.join_all();
+  }
+
+  /**
+   * Waits for the next segment in log order; 0 once all have been returned.
+   * The segment stays valid until release().
+   */
+  Segment *next(){
+    boost::mutex::scoped_lock lock(_lock);
+    if(_nextToWrite >= _segmentCount)
+      return 0;
+    Slot& slot = *_slots[_nextToWrite % _slots.size()];
+    while(!slot.ready)
+      _changed.wait(lock);
+    return &slot.segment;
+  }
+
+  void release(){
+    boost::mutex::scoped_lock lock(_lock);
+    _slots[_nextToWrite % _slots.size()]->ready = false;
+    _nextToWrite++;
+    _changed.notify_all();
+  }
+
+  bool failed(){
+    boost::mutex::scoped_lock lock(_lock);
+    return _failed;
+  }
+
+private:
+  struct Slot{
+    Slot() : ready(false) {}
+    Segment segment;
+    bool ready;
+  };
+
+  void work(){
+    std::vector<char> buffer;
+    while(true){
+      unsigned long long index;
+      {
+        boost::mutex::scoped_lock lock(_lock);
+        // Don't run further ahead of the writer than there are slots
+        while(_nextToParse < _segmentCount && _nextToParse >= _nextToWrite + _slots.size())
+          _changed.wait(lock);
+        if(_nextToParse >= _segmentCount)
+          return;
+        index = _nextToParse++;
+      }
+      Segment& segment = _slots[index % _slots.size()]->segment;
+      segment.clear();
+      bool ok = parse(index, buffer, segment);
+
+      boost::mutex::scoped_lock lock(_lock);
+      if(!ok)
+        _failed = true;
+      _slots[index % _slots.size()]->ready = true;
+      _changed.notify_all();
+    }
+  }
+
+  // A record belongs to the segment its first byte is in
+  bool parse(unsigned long long index, std::vector<char>& buffer, Segment& segment){
+    unsigned long long start = index * _segmentSize;
+    unsigned long long end = std::min(start + _segmentSize, _fileSize);
+    unsigned long long from = start > 0 ? start - 1 : 0;
+    buffer.resize(end - from);
+    if(!readAt(&buffer[0], end - from, from))
+      return false;
+
+    size_t begin = 0;
+    if(start > 0){
+      // Skip the tail of the record that started in the previous segment
+      const char *newline = (const char *)memchr(&buffer[0], '\n', buffer.size());
+      if(!newline)
+        return true;
+      begin = newline - &buffer[0] + 1;
+    }
+    // Pull in the rest of a record that runs over the end of the segment
+    size_t limit = end - from;
+    size_t scanned = limit - 1;
+    while(!memchr(&buffer[scanned], '\n', buffer.size() - scanned) && from + buffer.size() < _fileSize){
+      size_t size = buffer.size();
+      size_t n = std::min<unsigned long long>(4096, _fileSize - (from + size));
+      buffer.resize(size + n);
+      if(!readAt(&buffer[size], n, from + size))
+        return false;
+      scanned = size;
+    }
+
+    while(begin < limit && begin < buffer.size()){
+      const char *line = &buffer[begin];
+      const char *newline = (const char *)memchr(line, '\n', buffer.size() - begin);
+      size_t length = newline ? newline - line : buffer.size() - begin;
+      LogRecord record;
+      if(parseLogRecord(line, length, record))
+        segment.add(record);
+      else if(length > 0)
+        segment.skipped++;
+      begin += length + 1;
+    }
+    return true;
+  }
+
+  bool readAt(char *data, size_t length, unsigned long long offset){
+    while(length > 0){
+      ssize_t n = pread(_fd, data, length, offset);
+      if(n <= 0){
+        std::cerr << "Failed to read log at offset " << offset << std::endl;
+        return false;
+      }
+      data += n;
+      length -= n;
+      offset += n;
+    }
+    return true;
+  }
+
+  int _fd;
+  unsigned long long _fileSize;
+  size_t _segmentSize;
+  unsigned long long _segmentCount;
+  std::vector<boost::shared_ptr<Slot> > _slots;
+  boost::thread_group _threads;
+  boost::mutex _lock;
+  boost::condition_variable _changed;
+  unsigned long long _nextToParse;
+  unsigned long long _nextToWrite;
+  bool _failed;
+};
+
+/* ************************************************************************* */
+// Walks a mapped column file alongside the rows parsed from the log
+class ColumnVerifier{
+public:
+  ColumnVerifier() : _chunk(0), _row(0), _compared(0), _mismatches(0) {}
+
+  bool open(const std::string& path, const ColumnSpec *specs, int columnCount){
+    _path = path;
+    _specs.assign(specs, specs + columnCount);
+    if(!_reader.open(path))
+      return fail("cannot map the file");
+    if(_reader.columnCount() != columnCount)
+      return fail("wrong column count");
+    for(int c = 0; c < columnCount; c++)
+      if(_reader.columnName(c) != specs[c].name || _reader.columnType(c) != specs[c].type)
+        return fail("column " + _reader.columnName(c) + " does not match");
+    _min.resize(columnCount);
+    _max.resize(columnCount);
+    startChunk();
+    return true;
+  }
+
+  void compare(const ColumnBatch& batch){
+    size_t rows = batch.rows();
+    for(size_t r = 0; r < rows; r++, _compared++){
+      if(_chunk >= _reader.chunkCount())
+        continue;
+      for(size_t c = 0; c < _specs.size(); c++){
+        size_t width = columnTypeSize(_specs[c].type);
+        const char *expected = batch.column(c) + r * width;
+        const char *mapped = (const char *)_reader.chunkColumn(_chunk, c) + _row * width;
+        if(memcmp(expected, mapped, width) != 0)
+          mismatch(std::string("value of ") + _specs[c].name + " differs");
+        addToBounds(c, expected);
+      }
+      if(++_row == _reader.chunkRows(_chunk)){
+        checkBounds();
+        _chunk++;
+        startChunk();
+      }
+    }
+  }
+
+  bool finish(){
+    if(_compared != _reader.rows() || _chunk != _reader.chunkCount()){
+      char text[96];
+      snprintf(text, sizeof(text), "%llu rows in the log, %llu in the file",
+               _compared, _reader.rows());
+      _mismatches++;
+      return fail(text);
+    }
+    if(_mismatches)
+      return false;
+    std::cout << _path << ": " << _compared << " rows in " << _reader.chunkCount()
+              << " chunks verified" << std::endl;
+    return true;
+  }
+
+private:
+  bool fail(const std::string& what){
+    std::cerr << _path << ": " << what << std::endl;
+    return false;
+  }
+
+  // Only the first few differences are worth a line each
+  void mismatch(const std::string& what){
+    if(_mismatches++ < 10){
+      char where[64];
+      snprintf(where, sizeof(where), " at row %llu", _compared);
+      fail(what + where);
+    }
+  }
+
+  void startChunk(){
+    _row = 0;
+    for(size_t c = 0; c < _specs.size(); c++){
+      _min[c].i = 0;
+      _max[c].i = -1;
+      if(_specs[c].type == COLUMN_FLOAT64 || _specs[c].type == COLUMN_FLOAT32){
+        _min[c].f = INFINITY;
+        _max[c].f = -INFINITY;
+      }
+    }
+  }
+
+  // Bounds as documented in ColumnFile.h, worked out independently of the writer
+  void addToBounds(size_t c, const char *value){
+    double f = 0;
+    long long i = 0;
+    switch(_specs[c].type){
+    case COLUMN_FLOAT64:{ double v; memcpy(&v, value, 8); f = v; break; }
+    case COLUMN_FLOAT32:{ float v; memcpy(&v, value, 4); f = v; break; }
+    case COLUMN_INT64: memcpy(&i, value, 8); break;
+    case COLUMN_UINT8: i = (unsigned char)*value; break;
+    }
+    if(_specs[c].type == COLUMN_FLOAT64 || _specs[c].type == COLUMN_FLOAT32){
+      if(f != f)
+        return;
+      _min[c].f = std::min(_min[c].f, f);
+      _max[c].f = std::max(_max[c].f, f);
+    }
+    else{
+      _min[c].i = _row == 0 ? i : std::min(_min[c].i, i);
+      _max[c].i = _row == 0 ? i : std::max(_max[c].i, i);
+    }
+  }
+
+  void checkBounds(){
+    for(size_t c = 0; c < _specs.size(); c++){
+      ColumnBound min = _reader.chunkMin(_chunk, c), max = _reader.chunkMax(_chunk, c);
+      bool isFloat = _specs[c].type == COLUMN_FLOAT64 || _specs[c].type == COLUMN_FLOAT32;
+      if(isFloat ? (min.f != _min[c].f || max.f != _max[c].f) : (min.i != _min[c].i || max.i != _max[c].i))
+        mismatch(std::string("chunk bounds of ") + _specs[c].name + " differ");
+    }
+  }
+
+  std::string _path;
+  std::vector<ColumnSpec> _specs;
+  ColumnFileReader _reader;
+  std::vector<ColumnBound> _min, _max;
+  unsigned long long _chunk;
+  unsigned int _row;
+  unsigned long long _compared;
+  unsigned long long _mismatches;
+};
+
+bool Verify(int fd, unsigned long long fileSize, size_t segmentSize, int threads, const std::string& outDir){
+  ColumnVerifier verifiers[TABLE_COUNT];
+  bool ok = true;
+  for(int t = 0; t < TABLE_COUNT; t++)
+    ok = verifiers[t].open(outDir + k_tableTags[t] + ".col", k_tableColumns[t], k_tableColumnCounts[t]) && ok;
+  if(!ok)
+    return false;
+  {
+    SegmentPipeline pipeline(fd, fileSize, segmentSize, threads);
+    while(Segment *segment = pipeline.next()){
+      for(int t = 0; t < TABLE_COUNT; t++)
+        verifiers[t].compare(*segment->batches[t]);
+      pipeline.release();
+    }
+    ok = !pipeline.failed();
+  }
+  for(int t = 0; t < TABLE_COUNT; t++)
+    ok = verifiers[t].finish() && ok;
+  return ok;
+}
+
+/* ************************************************************************* */
+int main(int argc, char *argv[]){
+  if(argc < 2){
+    PrintUsage();
+    return -1;
+  }
+  std::string logDir(argv[1]);
+  std::string outDir(logDir);
+  int threads = boost::thread::hardware_concurrency();
+  unsigned int chunkRows = 65536;
+  bool verify = false;
+  for(int i = 2; i < argc; i++){
+    if(strncmp(argv[i], "--threads=", 10) == 0)
+      threads = atoi(argv[i] + 10);
+    else if(strcmp(argv[i], "--verify") == 0)
+      verify = true;
+    else if(strncmp(argv[i], "--chunk-rows=", 13) == 0)
+      chunkRows = atoi(argv[i] + 13);
+    else if(i == 2 && argv[i][0] != '-')
+      outDir = argv[i];
+    else{
+      PrintUsage();
+      return -1;
+    }
+  }
+  if(threads < 1)
+    threads = 1;
+  if(chunkRows < 1){
+    PrintUsage();
+    return -1;
+  }
+
+  std::string logPath = logDir + "log.txt";
+  int fd = open(logPath.c_str(), O_RDONLY);
+  if(fd < 0){
+    std::cerr << "Cannot open " << logPath << std::endl;
+    return -1;
+  }
+  struct stat st;
+  fstat(fd, &st);
+
+  ColumnFileWriter writers[TABLE_COUNT];
+  for(int t = 0; t < TABLE_COUNT; t++){
+    std::string path = outDir + k_tableTags[t] + ".col";
+    if(!writers[t].open(path, k_tableColumns[t], k_tableColumnCounts[t], chunkRows))
+      return -1;
+  }
+
+  // Segments of a few MB keep every core busy with little memory per slot
+  const size_t k_segmentSize = 8 << 20;
+  unsigned long long records = 0, skipped = 0;
+  bool ok = true;
+  {
+    SegmentPipeline pipeline(fd, st.st_size, k_segmentSize, threads);
+    while(Segment *segment = pipeline.next()){
+      for(int t = 0; t < TABLE_COUNT; t++)
+        ok = writers[t].append(*segment->batches[t]) && ok;
+      records += segment->records;
+      skipped += segment->skipped;
+      pipeline.release();
+    }
+    ok = !pipeline.failed() && ok;
+  }
+
+  for(int t = 0; t < TABLE_COUNT; t++){
+    ok = writers[t].close() && ok;
+    std::cout << outDir << k_tableTags[t] << ".col: " << writers[t].rows() << " rows" << std::endl;
+  }
+  std::cout << records << " records exported, " << skipped << " skipped, "
+            << threads << " threads" << std::endl;
+  if(ok && verify)
+    ok = Verify(fd, st.st_size, k_segmentSize, threads, outDir);
+  close(fd);
+  return ok ? 0 : -1;
+}
@@ -0,0 +1,295 @@
+/*
+ * logVerify.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Checks a bbLog log directory against its checksums.txt and prints, for
+ * every file that does not match, the offset of the first corrupt range.
+ * Files are cut into spans of a few MB that worker threads read and check
+ * in parallel, one large read per span, so the check runs at about the
+ * speed the card can be read.
+ *
+ * Before reading anything the CRC-32C kernel is checked against the
+ * standard check value and against the table driven implementation at
+ * unaligned offsets and lengths, so a broken kernel fails here instead of
+ * reporting every file as corrupt. --self-test runs only that check.
+ *
+ * Usage: logVerify /file/to/logdir/ [--threads=N]
+ *        logVerify --self-test
+ * Exits with 1 if anything is missing or corrupt, 2 if the self-test fails.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "log/ChecksumManifest.h"
+#include "util/Crc32c.h"
+
+/* ************************************************************************* */
+void PrintUsage(){
+  std::cout << "Usage: logVerify /file/to/logdir/ [--threads=N]" << std::endl
+            << "       logVerify --self-test" << std::endl;
+}
+
+/* ************************************************************************* */
+// The kernel crc32c() dispatches to against the check value of CRC-32C and
+// the table driven version, over every alignment of short and odd lengths
+bool CheckCrc32c(){
+  const char *k_check = "123456789";
+  const unsigned int k_checkValue = 0xE3069283;
+  bool ok = true;
+  if(crc32c(0, k_check, 9) != k_checkValue || crc32cSoftware(0, k_check, 9) != k_checkValue){
+    std::cerr << "CRC-32C of \"123456789\": " << std::hex << crc32c(0, k_check, 9) << " ("
+              << crc32cKernel() << "), " << crc32cSoftware(0, k_check, 9) << " (table), expected "
+              << k_checkValue << std::dec << std::endl;
+    ok = false;
+  }
+
+  unsigned char data[300];
+  unsigned int seed = 12345;
+  for(size_t i = 0; i < sizeof(data); i++){
+    seed = seed * 1103515245 + 12345;
+    data[i] = (unsigned char)(seed >> 16);
+  }
+  for(size_t offset = 0; offset < 8 && ok; offset++){
+    for(size_t length = 0; offset + length <= sizeof(data) && ok; length++){
+      unsigned int hardware = crc32c(0, data + offset, length);
+      unsigned int software = crc32cSoftware(0, data + offset, length);
+      // Chained over a split that leaves both halves unaligned
+      size_t split = length / 3;
+      unsigned int chained = crc32c(crc32c(0, data + offset, split), data + offset + split, length - split);
+      if(hardware != software || chained != software){
+        std::cerr << "CRC-32C mismatch at offset " << offset << ", length " << length << ": "
+                  << std::hex << hardware << " (" << crc32cKernel() << "), " << chained
+                  << " (chained), " << software << " (table)" << std::dec << std::endl;
+        ok = false;
+      }
+    }
+  }
+  return ok;
+}
+
+/* ************************************************************************* */
+bool EntryBefore(const ChecksumEntry& a, const ChecksumEntry& b){
+  if(a.name != b.name)
+    return a.name < b.name;
+  return a.offset < b.offset;
+}
+
+/* ************************************************************************* */
+// Outcome for one file; the first bad offset is the smallest over its spans
+struct FileResult{
+  FileResult() : missing(false), corrupt(false), firstBad(0), ranges(0), bytes(0) {}
+  bool missing;
+  bool corrupt;
+  unsigned long long firstBad;
+  unsigned long long ranges;
+  unsigned long long bytes;
+};
+
+/* ************************************************************************* */
+// Consecutive manifest entries of one file, read with a single pread
+struct Span{
+  size_t first;
+  size_t last;    // one past the last entry
+};
+
+/* ************************************************************************* */
+class Verifier{
+public:
+  Verifier(const std::string& logDir, const std::vector<ChecksumEntry>& entries,
+           const std::vector<Span>& spans, std::map<std::string, FileResult>& results)
+    : _logDir(logDir), _entries(entries), _spans(spans), _results(results), _next(0) {}
+
+  void run(int threads){
+    boost::thread_group group;
+    for(int i = 0; i < threads; i++)
+      group.create_thread(boost::bind(&Verifier::work, this));
+    group.join_all();
+  }
+
+private:
+  void work(){
+    std::vector<char> buffer;
+    std::string openName;
+    int fd = -1;
+    while(true){
+      size_t index;
+      {
+        boost::mutex::scoped_lock lock(_lock);
+        if(_next >= _spans.size())
+          break;
+        index = _next++;
+      }
+      const Span& span = _spans[index];
+      const ChecksumEntry& first = _entries[span.first];
+      if(first.name != openName){
+        if(fd >= 0)
+          close(fd);
+        openName = first.name;
+        fd = open((_logDir + openName).c_str(), O_RDONLY);
+      }
+      check(fd, span, buffer);
+    }
+    if(fd >= 0)
+      close(fd);
+  }
+
+  void check(int fd, const Span& span, std::vector<char>& buffer){
+    const ChecksumEntry& first = _entries[span.first];
+    const ChecksumEntry& last = _entries[span.last - 1];
+    unsigned long long begin = first.offset;
+    unsigned long long end = last.offset + last.length;
+    buffer.resize(end - begin);
+
+    size_t got = 0;
+    while(fd >= 0 && got < buffer.size()){
+      ssize_t n = pread(fd, &buffer[got], buffer.size() - got, begin + got);
+      if(n <= 0)
+        break;
+      got += n;
+    }
+
+    bool bad = false;
+    unsigned long long badOffset = 0, bytes = 0;
+    for(size_t i = span.first; i < span.last && !bad; i++){
+      const ChecksumEntry& e = _entries[i];
+      size_t at = e.offset - begin;
+      // Short reads (a truncated file) count as corrupt from the range on
+      if(at + e.length > got || crc32c(0, &buffer[at], e.length) != e.crc){
+        bad = true;
+        badOffset = e.offset;
+      }
+      bytes += e.length;
+    }
+
+    boost::mutex::scoped_lock lock(_lock);
+    FileResult& result = _results[first.name];
+    result.missing = result.missing || fd < 0;
+    result.ranges += span.last - span.first;
+    result.bytes += bytes;
+    if(bad && (!result.corrupt || badOffset < result.firstBad)){
+      result.corrupt = true;
+      result.firstBad = badOffset;
+    }
+  }
+
+  std::string _logDir;
+  const std::vector<ChecksumEntry>& _entries;
+  const std::vector<Span>& _spans;
+  std::map<std::string, FileResult>& _results;
+  boost::mutex _lock;
+  size_t _next;
+};
+
+/* ************************************************************************* */
+int main(int argc, char *argv[]){
+  if(argc < 2){
+    PrintUsage();
+    return -1;
+  }
+  bool crcOk = CheckCrc32c();
+  if(strcmp(argv[1], "--self-test") == 0){
+    std::cout << (crcOk ? "OK: " : "FAILED: ") << "CRC-32C self-test (" << crc32cKernel() << ")" << std::endl;
+    return crcOk ? 0 : 2;
+  }
+  if(!crcOk){
+    std::cerr << "CRC-32C self-test failed, not checking " << argv[1] << std::endl;
+    return 2;
+  }
+  std::string logDir(argv[1]);
+  int threads = boost::thread::hardware_concurrency();
+  for(int i = 2; i < argc; i++){
+    if(strncmp(argv[i], "--threads=", 10) == 0)
+      threads = atoi(argv[i] + 10);
+    else{
+      PrintUsage();
+      return -1;
+    }
+  }
+  if(threads < 1)
+    threads = 1;
+
+  std::string manifestPath = logDir + "checksums.txt";
+  FILE *manifest = fopen(manifestPath.c_str(), "r");
+  if(!manifest){
+    std::cerr << "Cannot open " << manifestPath << std::endl;
+    return -1;
+  }
+  std::vector<ChecksumEntry> entries;
+  unsigned long long malformed = 0;
+  char line[512];
+  while(fgets(line, sizeof(line), manifest)){
+    size_t length = strlen(line);
+    bool complete = length > 0 && line[length - 1] == '\n';
+    if(complete)
+      length--;
+    ChecksumEntry entry;
+    // A brown-out can cut the last line short
+    if(complete && parseChecksumLine(line, length, entry))
+      entries.push_back(entry);
+    else if(length > 0)
+      malformed++;
+  }
+  fclose(manifest);
+  std::sort(entries.begin(), entries.end(), EntryBefore);
+
+  // Spans of up to a few MB of contiguous ranges, for parallel large reads
+  const unsigned long long k_spanBytes = 4 << 20;
+  std::vector<Span> spans;
+  for(size_t i = 0; i < entries.size(); ){
+    Span span;
+    span.first = i;
+    unsigned long long bytes = entries[i].length;
+    i++;
+    while(i < entries.size() && entries[i].name == entries[i - 1].name &&
+          entries[i].offset == entries[i - 1].offset + entries[i - 1].length &&
+          bytes + entries[i].length <= k_spanBytes){
+      bytes += entries[i].length;
+      i++;
+    }
+    span.last = i;
+    spans.push_back(span);
+  }
+
+  timespec start, stop;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  std::map<std::string, FileResult> results;
+  Verifier verifier(logDir, entries, spans, results);
+  verifier.run(threads);
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+
+  unsigned long long bytes = 0, bad = 0;
+  for(std::map<std::string, FileResult>::const_iterator it = results.begin(); it != results.end(); ++it){
+    const FileResult& r = it->second;
+    bytes += r.bytes;
+    if(r.missing){
+      std::cout << "MISSING " << it->first << std::endl;
+      bad++;
+    }
+    else if(r.corrupt){
+      std::cout << "CORRUPT " << it->first << " at offset " << r.firstBad << std::endl;
+      bad++;
+    }
+  }
+  double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) * 1e-9;
+  std::cout << results.size() << " files, " << entries.size() << " ranges, "
+            << bytes / 1048576.0 << " MB checked in " << seconds << " s ("
+            << (seconds > 0 ? bytes / 1048576.0 / seconds : 0) << " MB/s, "
+            << threads << " threads, " << crc32cKernel() << ")" << std::endl;
+  if(malformed)
+    std::cout << malformed << " malformed manifest lines ignored" << std::endl;
+  std::cout << (bad ? "FAILED: " : "OK: ") << bad << " bad files" << std::endl;
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * logWindow.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Prints the records of a bbLog log directory that fall in a time window.
+ * log.idx takes it straight to the right part of log.txt (a binary search
+ * over the mapped index) and frames.idx lists the frame files of the window
+ * without touching the directory, so extracting a minute of a long flight
+ * reads about a minute of log.
+ *
+ * Output is in the log.txt format; frames come out as
+ *   frm <sec> <nsec> <path>
+ * for every file written for the frame, in time order with the records.
+ * These lines are made here from frames.idx; the per-frame record bbLog
+ * writes itself (with the frame's UTC) is tagged cam and passes through
+ * like any other record.
+ *
+ * Usage: logWindow /file/to/logdir/ START END [--sensors=imu,gps,att,jit,cam,frm]
+ * START and END are seconds on the clock of the log records. START can be
+ * +S for S seconds after the first record, END +S for S seconds after START.
+ */
+
+#include <iostream>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+#include "log/LogIndex.h"
+#include "log/LogWriter.h"
+
+/* ************************************************************************* */
+void PrintUsage(){
+  std::cout << "Usage: logWindow /file/to/logdir/ START END [--sensors=LIST]" << std::endl
+            << "  START, END       seconds on the log clock; +S is S seconds after the first" << std::endl
+            << "                   record for START, after START for END" << std::endl
+            << "  --sensors=LIST   comma separated record tags to keep, eg. imu,gps,att,jit,cam,frm" << std::endl
+            << "                   (frm selects the frame files; default is everything)" << std::endl;
+}
+
+/* ************************************************************************* */
+// Parses "12.5" or "+12.5" into nanoseconds; relative times are added to origin
+bool ParseTime(const char *text, long long origin, long long& stamp){
+  bool relative = text[0] == '+';
+  if(relative)
+    text++;
+  char *end;
+  double seconds = strtod(text, &end);
+  if(end == text || *end != '\0')
+    return false;
+  stamp = (long long)(seconds * 1e9 + (seconds < 0 ? -0.5 : 0.5)) + (relative ? origin : 0);
+  return true;
+}
+
+/* ************************************************************************* */
+class SensorFilter{
+public:
+  SensorFilter() : _all(true) {}
+
+  void parse(const char *list){
+    _all = false;
+    std::string s(list);
+    size_t begin = 0;
+    while(begin <= s.size()){
+      size_t end = s.find(',', begin);
+      if(end == std::string::npos)
+        end = s.size();
+      if(end > begin)
+        _tags.push_back(s.substr(begin, end - begin));
+      begin = end + 1;
+    }
+  }
+
+  bool accepts(const char *tag, size_t length) const{
+    if(_all)
+      return true;
+    for(size_t i = 0; i < _tags.size(); i++)
+      if(_tags[i].size() == length && memcmp(_tags[i].data(), tag, length) == 0)
+        return true;
+    return false;
+  }
+
+private:
+  bool _all;
+  std::vector<std::string> _tags;
+};
+
+/* ************************************************************************* */
+// Frames of the window, printed as the record stream passes their time
+class FramePrinter{
+public:
+  FramePrinter(const std::string& logDir, const TimeIndexReader& index, size_t first, size_t last)
+    : _logDir(logDir), _index(index), _next(first), _last(last) {}
+
+  void printUntil(long long stamp){
+    while(_next < _last && _index.entry(_next).stamp <= stamp)
+      print(_index.entry(_next++).stamp);
+  }
+
+private:
+  void print(long long stamp){
+    static const char *k_extensions[] = { ".pgm", ".fast" };
+    char name[64];
+    frameBaseName(stamp, name, sizeof(name));
+    for(size_t i = 0; i < sizeof(k_extensions) / sizeof(k_extensions[0]); i++){
+      std::string path = _logDir + name + k_extensions[i];
+      struct stat st;
+      if(stat(path.c_str(), &st) == 0)
+        printf("frm %lld %lld %s\n", stamp / 1000000000LL, stamp % 1000000000LL, path.c_str());
+    }
+  }
+
+  std::string _logDir;
+  const TimeIndexReader& _index;
+  size_t _next;
+  size_t _last;
+};
+
+/* ************************************************************************* */
+int main(int argc, char *argv[]){
+  if(argc < 4){
+    PrintUsage();
+    return -1;
+  }
+  std::string logDir(argv[1]);
+  SensorFilter sensors;
+  for(int i = 4; i < argc; i++){
+    if(strncmp(argv[i], "--sensors=", 10) == 0)
+      sensors.parse(argv[i] + 10);
+    else{
+      PrintUsage();
+      return -1;
+    }
+  }
+
+  std::string logPath = logDir + "log.txt";
+  int fd = open(logPath.c_str(), O_RDONLY);
+  if(fd < 0){
+    std::cerr << "Cannot open " << logPath << std::endl;
+    return -1;
+  }
+  struct stat st;
+  fstat(fd, &st);
+  unsigned long long logSize = st.st_size;
+
+  TimeIndexReader logIndex, frameIndex;
+  bool indexed = logIndex.open((logDir + "log.idx").c_str(), kLogIndexMagic) && logIndex.size() > 0;
+  if(!indexed)
+    std::cerr << "No usable log.idx, scanning all of " << logPath << std::endl;
+  bool haveFrames = frameIndex.open((logDir + "frames.idx").c_str(), kFrameIndexMagic);
+
+  long long origin = indexed ? logIndex.entry(0).stamp : 0;
+  if(!indexed && argv[2][0] == '+'){
+    // Without an index the first record gives the origin
+    char line[256];
+    ssize_t n = pread(fd, line, sizeof(line), 0);
+    LogRecord first;
+    if(n <= 0 || !parseLogRecord(line, n, first)){
+      std::cerr << "Cannot read the first record of " << logPath << std::endl;
+      return -1;
+    }
+    origin = first.stamp;
+  }
+  long long start, end;
+  if(!ParseTime(argv[2], origin, start) || !ParseTime(argv[3], start, end) || end < start){
+    PrintUsage();
+    return -1;
+  }
+
+  // Records are only nearly in time order (each sensor is stamped on its
+  // own schedule), so the scan starts one index point early and ends one late.
+  unsigned long long from = 0, to = logSize;
+  if(indexed){
+    size_t first = logIndex.upperBound(start);
+    first = first >= 2 ? first - 2 : 0;
+    from = logIndex.entry(first).offset;
+    size_t last = logIndex.upperBound(end) + 1;
+    if(last < logIndex.size())
+      to = logIndex.entry(last).offset;
+  }
+  if(to > logSize)
+    to = logSize;
+
+  size_t firstFrame = 0, lastFrame = 0;
+  if(haveFrames && sensors.accepts("frm", 3)){
+    firstFrame = start > 0 ? frameIndex.upperBound(start - 1) : 0;
+    lastFrame = frameIndex.upperBound(end);
+  }
+  FramePrinter frames(logDir, frameIndex, firstFrame, lastFrame);
+
+  // Stream the byte range, a buffer at a time
+  const size_t k_bufferSize = 1 << 20;
+  std::vector<char> buffer(k_bufferSize);
+  size_t used = 0;
+  unsigned long long position = from;
+  while(position < to || used > 0){
+    size_t want = k_bufferSize - used;
+    if(want > to - position)
+      want = to - position;
+    ssize_t n = want > 0 ? pread(fd, &buffer[used], want, position) : 0;
+    if(n < 0){
+      std::cerr << "Read failed at offset " << position << std::endl;
+      return -1;
+    }
+    position += n;
+    used += n;
+    bool atEnd = n == 0 || position >= to;
+
+    size_t begin = 0;
+    while(begin < used){
+      const char *line = &buffer[begin];
+      const char *newline = (const char *)memchr(line, '\n', used - begin);
+      if(!newline && !atEnd)
+        break;
+      size_t length = newline ? newline - line : used - begin;
+      LogRecord record;
+      if(parseLogRecord(line, length, record) && record.stamp >= start && record.stamp <= end){
+        frames.printUntil(record.stamp);
+        if(sensors.accepts(record.tag, record.tagLength)){
+          fwrite(line, 1, length, stdout);
+          fputc('\n', stdout);
+        }
+      }
+      begin += length + (newline ? 1 : 0);
+    }
+    if(begin == 0 && used == k_bufferSize){
+      std::cerr << "Record longer than " << k_bufferSize << " bytes at offset "
+                << position - used << ", skipped" << std::endl;
+      begin = used;
+    }
+    memmove(&buffer[0], &buffer[begin], used - begin);
+    used -= begin;
+    if(atEnd && used == 0)
+      break;
+  }
+  frames.printUntil(end);
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,619 @@
+/*
+ * serialCheck.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Runs ASIOSerialPort against pseudo terminals and checks the behaviour
+ * the rest of bbLog relies on: priority order of the transmit queue,
+ * completion of messages dropped by close() or to the queue limit, a
+ * transmit stalled by the device timing out without holding up close(),
+ * read deadlines that hold when signals arrive, and recovery from a device
+ * that goes away: the disconnect and reconnect events, READ_ERROR from
+ * readers while it is gone, the reopen backoff growing to kReopenMaxMs and
+ * reads resuming after. The telemetry downlink is run end to end: IMU,
+ * GPS and camera updates go through TelemetryDownlink into the port, the
+ * far side decodes what arrives with a frame dropped on the way, and the
+ * values, the lost frame count and the byte budget are checked.
+ * The reconnect check keeps the device away on purpose and takes ~12 s.
+ * Prints one line per check and exits with 1 if any of them failed.
+ *
+ * Usage: serialCheck
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "serial/ASIOSerialPort.h"
+#include "telemetry/TelemetryDownlink.h"
+
+/* ************************************************************************* */
+// Opens a raw pty pair, returns the master fd and the slave device name.
+// The slave fd is returned in slaveFd if given, otherwise it stays open
+int OpenPty(char *name, int *slaveFd = 0){
+  int master, slave;
+  if(openpty(&master, &slave, name, 0, 0) < 0)
+    return -1;
+  struct termios t;
+  tcgetattr(slave, &t);
+  cfmakeraw(&t);
+  tcsetattr(slave, TCSANOW, &t);
+  fcntl(master, F_SETFL, O_NONBLOCK);
+  if(slaveFd)
+    *slaveFd = slave;
+  return master;
+}
+
+double SecondsSince(const timespec& start){
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+// Reads from the master until want bytes arrived or timeoutMs passed
+size_t ReadMaster(int master, char *buf, size_t want, int timeoutMs){
+  size_t got = 0;
+  while(got < want){
+    pollfd pfd = { master, POLLIN, 0 };
+    if(poll(&pfd, 1, timeoutMs) <= 0)
+      break;
+    ssize_t n = read(master, buf + got, want - got);
+    if(n <= 0)
+      break;
+    got += n;
+  }
+  return got;
+}
+
+bool Report(const char *check, bool ok, const std::string& detail = ""){
+  std::cout << (ok ? "ok   " : "FAIL ") << check;
+  if(!detail.empty())
+    std::cout << ": " << detail;
+  std::cout << std::endl;
+  return ok;
+}
+
+/* ************************************************************************* */
+// Holds the transmit thread in a completion handler until opened, so the
+// queue can be lined up behind it
+class TxGate{
+public:
+  TxGate() : _entered(false), _open(false) {}
+
+  void hold(const boost::system::error_code&, size_t){
+    boost::mutex::scoped_lock lock(_lock);
+    _entered = true;
+    _changed.notify_all();
+    while(!_open)
+      _changed.wait(lock);
+  }
+
+  bool waitEntered(){
+    boost::mutex::scoped_lock lock(_lock);
+    boost::system_time timeout = boost::get_system_time() + boost::posix_time::seconds(2);
+    while(!_entered)
+      if(!_changed.timed_wait(lock, timeout))
+        return false;
+    return true;
+  }
+
+  void open(){
+    boost::mutex::scoped_lock lock(_lock);
+    _open = true;
+    _changed.notify_all();
+  }
+
+private:
+  boost::mutex _lock;
+  boost::condition_variable _changed;
+  bool _entered;
+  bool _open;
+};
+
+class CompletionCounter{
+public:
+  CompletionCounter() : sent(0), aborted(0), dropped(0), failed(0) {}
+
+  void done(const boost::system::error_code& err, size_t){
+    boost::mutex::scoped_lock lock(_lock);
+    if(!err)
+      sent++;
+    else if(err == boost::asio::error::operation_aborted)
+      aborted++;
+    else if(err == boost::asio::error::no_buffer_space)
+      dropped++;
+    else
+      failed++;
+  }
+
+  int failedSoFar(){
+    boost::mutex::scoped_lock lock(_lock);
+    return failed;
+  }
+
+  int sent, aborted, dropped, failed;
+
+private:
+  boost::mutex _lock;
+};
+
+/* ************************************************************************* */
+// LOW queued before HIGH, both behind a message on the wire: HIGH goes first
+bool CheckPriorityOrder(){
+  char name[64];
+  int master = OpenPty(name);
+  ASIOSerialPort port(name, 57600);
+
+  TxGate gate;
+  port.asyncWrite("A", 1, WRITE_PRIORITY_NORMAL,
+                  boost::bind(&TxGate::hold, &gate, boost::asio::placeholders::error,
+                              boost::asio::placeholders::bytes_transferred));
+  if(!gate.waitEntered()){
+    gate.open();
+    return Report("priority order", false, "first message never completed");
+  }
+  port.asyncWrite("L", 1, WRITE_PRIORITY_LOW);
+  port.asyncWrite("N", 1, WRITE_PRIORITY_NORMAL);
+  port.asyncWrite("H", 1, WRITE_PRIORITY_HIGH);
+  gate.open();
+
+  char buf[8];
+  size_t n = ReadMaster(master, buf, 4, 1000);
+  port.close();
+  close(master);
+  std::string order(buf, n);
+  return Report("priority order", order == "AHNL", "wrote \"" + order + "\", expected \"AHNL\"");
+}
+
+// Messages still queued when the port is closed complete with operation_aborted
+bool CheckAbortOnClose(){
+  char name[64];
+  int master = OpenPty(name);
+  ASIOSerialPort port(name, 57600);
+
+  const int k_queued = 5;
+  TxGate gate;
+  CompletionCounter counter;
+  port.asyncWrite("A", 1, WRITE_PRIORITY_NORMAL,
+                  boost::bind(&TxGate::hold, &gate, boost::asio::placeholders::error,
+                              boost::asio::placeholders::bytes_transferred));
+  bool entered = gate.waitEntered();
+  for(int i = 0; i < k_queued; i++)
+    port.asyncWrite("q", 1, WRITE_PRIORITY_LOW,
+                    boost::bind(&CompletionCounter::done, &counter, boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred));
+
+  // close() stops the transmit thread, which leaves the queue untouched once
+  // it is let out of the handler
+  boost::thread closer(boost::bind(&ASIOSerialPort::close, &port));
+  usleep(100000);
+  gate.open();
+  closer.join();
+  close(master);
+
+  char detail[128];
+  snprintf(detail, sizeof(detail), "%d aborted, %d sent, %d failed of %d queued",
+           counter.aborted, counter.sent, counter.failed, k_queued);
+  return Report("completion on close", entered && counter.aborted == k_queued, detail);
+}
+
+// A full queue makes room by dropping the oldest of its lowest priority, or
+// refuses a message ranking below everything queued
+bool CheckQueueLimit(){
+  char name[64];
+  int master = OpenPty(name);
+  ASIOSerialPort port(name, 57600);
+  port.setWriteQueueLimit(4);
+
+  TxGate gate;
+  CompletionCounter counter;
+  port.asyncWrite("A", 1, WRITE_PRIORITY_NORMAL,
+                  boost::bind(&TxGate::hold, &gate, boost::asio::placeholders::error,
+                              boost::asio::placeholders::bytes_transferred));
+  bool entered = gate.waitEntered();
+  const char *k_normal = "1234";
+  for(int i = 0; i < 4; i++)
+    port.asyncWrite(k_normal + i, 1, WRITE_PRIORITY_NORMAL,
+                    boost::bind(&CompletionCounter::done, &counter, boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred));
+  port.asyncWrite("L", 1, WRITE_PRIORITY_LOW,
+                  boost::bind(&CompletionCounter::done, &counter, boost::asio::placeholders::error,
+                              boost::asio::placeholders::bytes_transferred));
+  port.asyncWrite("H", 1, WRITE_PRIORITY_HIGH,
+                  boost::bind(&CompletionCounter::done, &counter, boost::asio::placeholders::error,
+                              boost::asio::placeholders::bytes_transferred));
+  gate.open();
+
+  char buf[8];
+  size_t n = ReadMaster(master, buf, 5, 1000);
+  port.close();
+  close(master);
+  std::string order(buf, n);
+  WriteQueueStats stats = port.writeStats();
+  char detail[160];
+  snprintf(detail, sizeof(detail), "wrote \"%s\", expected \"AH234\"; %d dropped, %llu counted",
+           order.c_str(), counter.dropped, stats.messagesDropped);
+  return Report("queue limit", entered && order == "AH234" && counter.dropped == 2 &&
+                stats.messagesDropped == 2, detail);
+}
+
+// A device that takes nothing: the stalled batch fails with timed_out and
+// close() returns promptly, aborting the rest
+bool CheckStalledTransmit(){
+  char name[64];
+  int master = OpenPty(name);
+  ASIOSerialPort port(name, 57600);
+
+  // Far more than the pty buffers, and nobody reads the master
+  const int k_messages = 200;
+  std::string block(512, 's');
+  CompletionCounter counter;
+  for(int i = 0; i < k_messages; i++)
+    port.asyncWrite(block, WRITE_PRIORITY_NORMAL,
+                    boost::bind(&CompletionCounter::done, &counter, boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred));
+  timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  while(counter.failedSoFar() == 0 && SecondsSince(start) < 5)
+    usleep(20000);
+  double stallSeconds = SecondsSince(start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  port.close();
+  double closeSeconds = SecondsSince(start);
+  close(master);
+
+  char detail[160];
+  snprintf(detail, sizeof(detail), "%d sent, %d timed out after %.2f s, %d aborted by a close() of %.3f s",
+           counter.sent, counter.failed, stallSeconds, counter.aborted, closeSeconds);
+  return Report("stalled transmit", counter.failed > 0 && counter.aborted > 0 && closeSeconds < 0.5 &&
+                counter.sent + counter.failed + counter.aborted == k_messages, detail);
+}
+
+/* ************************************************************************* */
+// Far side of the radio: cuts the byte stream into frames, loses one of
+// them, and decodes the rest
+class TelemetryReceiver{
+public:
+  TelemetryReceiver(int master, unsigned long long dropFrame)
+    : LmessageEvent(this), bytes(0), frames(0), _master(master), _dropFrame(dropFrame), _length(0)
+  {
+    _decoder.onMessage += &LmessageEvent;
+  }
+
+  void drain(){
+    ssize_t n;
+    while((n = read(_master, _stream + _length, sizeof(_stream) - _length)) > 0){
+      bytes += n;
+      _length += n;
+      size_t pos = 0;
+      // Header: sync, sync, payload length, sequence (2), type; CRC-16 after the payload
+      while(pos + 3 <= _length){
+        size_t frameSize = 6 + _stream[pos + 2] + 2;
+        if(pos + frameSize > _length)
+          break;
+        if(frames++ != _dropFrame)
+          _decoder.feed(_stream + pos, frameSize);
+        pos += frameSize;
+      }
+      memmove(_stream, _stream + pos, _length - pos);
+      _length -= pos;
+    }
+  }
+
+  void messageEvent(const TelemetryMessage& msg){
+    received.push_back(msg);
+  }
+  LISTENER(TelemetryReceiver, messageEvent, const TelemetryMessage&);
+
+  const TelemetryDecoderStats& stats() const { return _decoder.stats(); }
+
+  std::vector<TelemetryMessage> received;
+  unsigned long long bytes;
+  unsigned long long frames;
+
+private:
+  int _master;
+  unsigned long long _dropFrame;
+  TelemetryDecoder _decoder;
+  unsigned char _stream[4096];
+  size_t _length;
+};
+
+// Outcome of pushing 10 s of updates through a downlink
+struct DownlinkRun{
+  TelemetryDownlinkStats sent;
+  TelemetryDecoderStats decoded;
+  unsigned long long framesArrived;
+  unsigned long long bytesArrived;
+  int mismatched;
+  int types[TELEMETRY_TYPE_COUNT];
+  double allowedBytes;
+};
+
+// IMU, GPS and camera updates through the downlink and the port on a
+// simulated clock, attitude every attitudePeriod seconds. The far side
+// loses frame dropFrame and compares what it decodes with what was sent
+DownlinkRun RunDownlink(size_t budget, double attitudePeriod, unsigned long long dropFrame){
+  char name[64];
+  int master = OpenPty(name);
+  ASIOSerialPort radio(name, 57600);
+  TelemetryDownlink downlink(radio, budget);
+  downlink.setPeriod(TELEMETRY_ATTITUDE, attitudePeriod);
+  TelemetryReceiver receiver(master, dropFrame);
+
+  const long long k_start = 5000000000LL;
+  const long long k_step = 10000000;
+  const int k_steps = 1000;
+  std::vector<TelemetryMessage> sent;
+  for(int i = 0; i < k_steps; i++){
+    long long now = k_start + i * k_step;
+    sent.push_back(attitudeTelemetry(now, 0.001f * i, -0.5f + 0.0005f * i, 3.0f - 0.006f * i));
+    downlink.update(sent.back());
+    if(i % 20 == 0){
+      GpsFix fix = emptyGpsFix();
+      fix.stamp = now;
+      fix.latitude = 33.7756 + 1e-6 * i;
+      fix.longitude = -84.3963 - 2e-6 * i;
+      fix.altitude = 300.f + 0.1f * i;
+      fix.speed = 0.05f * i;
+      fix.course = (float)(i % 360);
+      fix.fixQuality = 1;
+      fix.satellites = (unsigned char)(6 + i % 5);
+      sent.push_back(gpsTelemetry(fix));
+      downlink.update(sent.back());
+    }
+    if(i % 50 == 0){
+      sent.push_back(cameraTelemetry(now, i / 5, i / 100, 100 + i));
+      downlink.update(sent.back());
+    }
+    downlink.poll(now);
+    usleep(1000);
+    receiver.drain();
+  }
+  // Whatever is still on its way
+  for(int i = 0; i < 20 && radio.writeQueueDepth() > 0; i++)
+    usleep(10000);
+  usleep(50000);
+  receiver.drain();
+  radio.close();
+  close(master);
+
+  DownlinkRun run;
+  memset(&run, 0, sizeof(run));
+  for(size_t r = 0; r < receiver.received.size(); r++){
+    const TelemetryMessage& got = receiver.received[r];
+    run.types[got.type]++;
+    bool found = false;
+    for(size_t s = 0; s < sent.size() && !found; s++){
+      if(sent[s].type != got.type || sent[s].values[0] != got.values[0])
+        continue;
+      found = true;
+      for(int f = 0; f < telemetryFieldCount(got.type); f++)
+        found = found && sent[s].values[f] == got.values[f];
+    }
+    run.mismatched += !found;
+  }
+  run.sent = downlink.stats();
+  run.decoded = receiver.stats();
+  run.framesArrived = receiver.frames;
+  run.bytesArrived = receiver.bytes;
+  // The bucket starts full with half a second of budget
+  run.allowedBytes = budget * (k_steps * k_step * 1e-9 + 0.5);
+  return run;
+}
+
+std::string DescribeRun(const DownlinkRun& run){
+  char text[256];
+  snprintf(text, sizeof(text), "%llu frames sent, %llu arrived, %llu decoded (%d attitude, %d gps, %d camera), "
+           "%d mismatched, %llu lost, %llu crc errors, %llu bytes for %.0f allowed, %llu held back",
+           run.sent.framesSent, run.framesArrived, run.decoded.frames, run.types[TELEMETRY_ATTITUDE],
+           run.types[TELEMETRY_GPS], run.types[TELEMETRY_CAMERA], run.mismatched, run.decoded.lostFrames,
+           run.decoded.crcErrors, run.bytesArrived, run.allowedBytes, run.sent.overBudget);
+  return text;
+}
+
+// With room for every type, all three arrive with the values sent and the
+// dropped frame counted as lost. With attitude wanting several times the
+// budget, the bytes on the wire stay within it
+bool CheckTelemetryDownlink(){
+  DownlinkRun roomy = RunDownlink(250, 0.1, 7);
+  bool roomyOk = roomy.framesArrived == roomy.sent.framesSent && roomy.bytesArrived == roomy.sent.bytesSent &&
+                 roomy.decoded.frames == roomy.sent.framesSent - 1 && roomy.decoded.lostFrames == 1 &&
+                 roomy.decoded.crcErrors == 0 && roomy.mismatched == 0 && roomy.types[TELEMETRY_ATTITUDE] > 0 &&
+                 roomy.types[TELEMETRY_GPS] > 0 && roomy.types[TELEMETRY_CAMERA] > 0 &&
+                 roomy.bytesArrived <= roomy.allowedBytes;
+  DownlinkRun tight = RunDownlink(250, 0.02, 100);
+  bool tightOk = tight.framesArrived == tight.sent.framesSent && tight.decoded.lostFrames == 1 &&
+                 tight.decoded.crcErrors == 0 && tight.mismatched == 0 && tight.sent.overBudget > 0 &&
+                 tight.bytesArrived <= tight.allowedBytes;
+  return Report("telemetry downlink", roomyOk && tightOk,
+                DescribeRun(roomy) + "; at 50 Hz attitude " + DescribeRun(tight));
+}
+
+/* ************************************************************************* */
+void IgnoreSignal(int){}
+
+class DeadlineReader{
+public:
+  DeadlineReader(ASIOSerialPort& port, int timeoutMs)
+    : status(READ_OK), seconds(0), _port(port), _timeoutMs(timeoutMs) {}
+
+  void run(){
+    char buf[64];
+    size_t n;
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    status = _port.readUntil(buf, sizeof(buf), "\n", n, _timeoutMs);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+  }
+
+  ReadStatus status;
+  double seconds;
+
+private:
+  ASIOSerialPort& _port;
+  int _timeoutMs;
+};
+
+// Signals during a read on a silent port: it still times out at its deadline
+bool CheckDeadlineUnderSignals(){
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = IgnoreSignal;
+  sigaction(SIGUSR1, &action, 0);
+
+  char name[64];
+  int master = OpenPty(name);
+  ASIOSerialPort port(name, 57600);
+
+  const int k_timeoutMs = 200;
+  DeadlineReader reader(port, k_timeoutMs);
+  boost::thread thread(boost::bind(&DeadlineReader::run, &reader));
+  for(int i = 0; i < 5; i++){
+    usleep(20000);
+    pthread_kill(thread.native_handle(), SIGUSR1);
+  }
+  bool returned = thread.timed_join(boost::posix_time::seconds(2));
+  // A stuck reader is woken by the hang up
+  close(master);
+  thread.join();
+
+  char detail[128];
+  snprintf(detail, sizeof(detail), "%s after %.3f s, deadline %.3f s",
+           !returned ? "stuck" : reader.status == READ_TIMEOUT ? "timed out" : "returned early",
+           reader.seconds, k_timeoutMs * 1e-3);
+  return Report("read deadline under signals",
+                returned && reader.status == READ_TIMEOUT && reader.seconds < 2 * k_timeoutMs * 1e-3, detail);
+}
+
+/* ************************************************************************* */
+class ConnectionWatcher{
+public:
+  ConnectionWatcher()
+    : LonDisconnect(this), LonReconnect(this), disconnects(0), reconnects(0), attempts(0), downSeconds(0) {}
+
+  void onDisconnect(const SerialConnectionChange&){
+    boost::mutex::scoped_lock lock(_lock);
+    disconnects++;
+  }
+  LISTENER(ConnectionWatcher, onDisconnect, const SerialConnectionChange&);
+
+  void onReconnect(const SerialConnectionChange& change){
+    boost::mutex::scoped_lock lock(_lock);
+    reconnects++;
+    attempts = change.attempts;
+    downSeconds = change.downSeconds;
+  }
+  LISTENER(ConnectionWatcher, onReconnect, const SerialConnectionChange&);
+
+  int disconnects, reconnects;
+  unsigned int attempts;
+  double downSeconds;
+
+private:
+  boost::mutex _lock;
+};
+
+// The device behind a path hangs up and a new one appears there later: the
+// port notices, backs off to kReopenMaxMs between reopen attempts and
+// reads from the new device
+bool CheckReconnect(){
+  char dir[] = "/tmp/serialCheck-XXXXXX";
+  if(!mkdtemp(dir))
+    return Report("reconnect", false, "no temporary directory");
+  std::string link = std::string(dir) + "/tty";
+
+  char name[64];
+  int slave;
+  int master = OpenPty(name, &slave);
+  symlink(name, link.c_str());
+  ASIOSerialPort port(link, 57600);
+  ConnectionWatcher watcher;
+  port.onDisconnect += &watcher.LonDisconnect;
+  port.onReconnect += &watcher.LonReconnect;
+
+  // When the backoff first waits kReopenMaxMs, and how many attempts it took to get there
+  double maxAttemptAt = ASIOSerialPort::kReopenFirstMs * 1e-3;
+  unsigned int maxAttempts = 1;
+  for(int delay = ASIOSerialPort::kReopenFirstMs; delay < ASIOSerialPort::kReopenMaxMs; maxAttempts++){
+    delay = std::min(2 * delay, (int)ASIOSerialPort::kReopenMaxMs);
+    maxAttemptAt += delay * 1e-3;
+  }
+  // The new device shows up in the middle of the longest wait
+  double restoreAt = maxAttemptAt - ASIOSerialPort::kReopenMaxMs * 0.5e-3;
+
+  const int k_timeoutMs = 200;
+  char buf[64];
+  size_t n;
+  write(master, "before\n", 7);
+  ReadStatus status = port.readUntil(buf, sizeof(buf), "\n", n, k_timeoutMs);
+  bool readBefore = status == READ_OK && std::string(buf, n) == "before";
+
+  // Hang up, device gone
+  timespec hangup;
+  clock_gettime(CLOCK_MONOTONIC, &hangup);
+  close(master);
+  close(slave);
+  unlink(link.c_str());
+  int reads = 0, errors = 0;
+  while(SecondsSince(hangup) < restoreAt){
+    errors += port.readUntil(buf, sizeof(buf), "\n", n, k_timeoutMs) == READ_ERROR;
+    reads++;
+  }
+  int disconnects = watcher.disconnects;
+
+  // A new device at the same path
+  master = OpenPty(name, &slave);
+  symlink(name, link.c_str());
+  while(!port.isConnected() && SecondsSince(hangup) < maxAttemptAt + 2)
+    port.readUntil(buf, sizeof(buf), "\n", n, k_timeoutMs);
+  write(master, "after\n", 6);
+  status = port.readUntil(buf, sizeof(buf), "\n", n, 1000);
+  bool readAfter = status == READ_OK && std::string(buf, n) == "after";
+
+  port.close();
+  close(master);
+  close(slave);
+  unlink(link.c_str());
+  rmdir(dir);
+
+  bool ok = readBefore && disconnects == 1 && reads > 0 && errors == reads &&
+            watcher.reconnects == 1 && watcher.attempts == maxAttempts &&
+            watcher.downSeconds > maxAttemptAt - 0.05 && watcher.downSeconds < maxAttemptAt + 0.5 &&
+            readAfter;
+  char detail[256];
+  snprintf(detail, sizeof(detail), "%d disconnect(s), %d of %d reads failed, %d reconnect(s) after %u attempts "
+           "and %.2f s (expected %u and %.2f s), read %s before and %s after",
+           disconnects, errors, reads, watcher.reconnects, watcher.attempts, watcher.downSeconds,
+           maxAttempts, maxAttemptAt, readBefore ? "ok" : "failed", readAfter ? "ok" : "failed");
+  return Report("reconnect", ok, detail);
+}
+
+/* ************************************************************************* */
+int main(){
+  int failures = 0;
+  failures += !CheckPriorityOrder();
+  failures += !CheckAbortOnClose();
+  failures += !CheckQueueLimit();
+  failures += !CheckStalledTransmit();
+  failures += !CheckTelemetryDownlink();
+  failures += !CheckDeadlineUnderSignals();
+  failures += !CheckReconnect();
+  if(failures){
+    std::cout << failures << " check(s) failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
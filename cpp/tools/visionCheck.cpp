@@ -0,0 +1,222 @@
+/*
+ * visionCheck.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Checks that the SIMD kernels of the on-board vision code give exactly
+ * what their scalar reference paths give: FAST corners (keypoint lists)
+ * over synthetic images of assorted sizes, strides and thresholds, with the
+ * strongest corners kept past the keypoint cap, and the
+ * frame change filter (block sums and change values) over sequences of
+ * synthetic frames, including frames smaller than one block.
+ * Prints one line per check and exits with 1 if any of them failed.
+ *
+ * Usage: visionCheck
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+#include <vector>
+
+#include "vision/FastCorners.h"
+#include "vision/FrameChange.h"
+
+/* ************************************************************************* */
+// Deterministic pseudo random numbers, so a failure can be reproduced
+class Lcg{
+public:
+  Lcg(unsigned int seed) : _state(seed) {}
+  unsigned int next(){
+    _state = _state * 1664525u + 1013904223u;
+    return _state >> 8;
+  }
+private:
+  unsigned int _state;
+};
+
+// Noise under bright and dark rectangles, which gives corners of every
+// orientation plus plenty of candidates that fail the segment test
+void SyntheticImage(std::vector<unsigned char>& img, int width, int height, int stride, unsigned int seed){
+  Lcg rng(seed);
+  img.assign((size_t)stride * height, 0);
+  for(int y = 0; y < height; y++)
+    for(int x = 0; x < stride; x++)
+      img[(size_t)y * stride + x] = (unsigned char)(100 + rng.next() % 24);
+  int rectangles = 1 + width * height / 400;
+  for(int r = 0; r < rectangles; r++){
+    int x0 = rng.next() % width, y0 = rng.next() % height;
+    int x1 = x0 + 2 + rng.next() % 24, y1 = y0 + 2 + rng.next() % 24;
+    unsigned char value = (unsigned char)(rng.next() % 2 ? 200 + rng.next() % 56 : rng.next() % 40);
+    for(int y = y0; y < y1 && y < height; y++)
+      for(int x = x0; x < x1 && x < width; x++)
+        img[(size_t)y * stride + x] = value;
+  }
+}
+
+bool SameKeypoints(const std::vector<Keypoint>& a, const std::vector<Keypoint>& b){
+  if(a.size() != b.size())
+    return false;
+  for(size_t i = 0; i < a.size(); i++)
+    if(a[i].x != b[i].x || a[i].y != b[i].y || a[i].score != b[i].score)
+      return false;
+  return true;
+}
+
+bool Stronger(const Keypoint& a, const Keypoint& b){
+  if(a.score != b.score)
+    return a.score > b.score;
+  return a.y != b.y ? a.y < b.y : a.x < b.x;
+}
+
+bool RasterOrder(const Keypoint& a, const Keypoint& b){
+  return a.y != b.y ? a.y < b.y : a.x < b.x;
+}
+
+bool Report(const char *check, bool ok, const std::string& detail = ""){
+  std::cout << (ok ? "ok   " : "FAIL ") << check;
+  if(!detail.empty())
+    std::cout << ": " << detail;
+  std::cout << std::endl;
+  return ok;
+}
+
+/* ************************************************************************* */
+bool CheckFastCorners(){
+  struct Size { int width, height, stride; };
+  const Size k_sizes[] = { {640, 480, 640}, {320, 240, 384}, {37, 23, 37}, {16, 16, 16}, {19, 9, 32}, {7, 7, 7} };
+  const int k_thresholds[] = { 5, 20, 60 };
+  const size_t k_maxKeypoints = 5000;
+
+  int cases = 0, mismatches = 0;
+  size_t corners = 0;
+  char detail[160] = "";
+  std::vector<unsigned char> img;
+  std::vector<Keypoint> simd, scalar;
+  for(size_t s = 0; s < sizeof(k_sizes) / sizeof(Size); s++){
+    const Size& size = k_sizes[s];
+    SyntheticImage(img, size.width, size.height, size.stride, 17 + s);
+    for(size_t t = 0; t < sizeof(k_thresholds) / sizeof(int); t++){
+      for(int nonmax = 0; nonmax < 2; nonmax++){
+        FastDetector vector(k_thresholds[t], nonmax != 0), reference(k_thresholds[t], nonmax != 0);
+        reference.setUseSimd(false);
+        size_t found = vector.detect(&img[0], size.width, size.height, size.stride, simd, k_maxKeypoints);
+        size_t expected = reference.detect(&img[0], size.width, size.height, size.stride, scalar, k_maxKeypoints);
+        cases++;
+        corners += expected;
+        if(found != expected || !SameKeypoints(simd, scalar)){
+          if(!mismatches)
+            snprintf(detail, sizeof(detail), "%dx%d stride %d threshold %d nonmax %d: %zu corners, expected %zu",
+                     size.width, size.height, size.stride, k_thresholds[t], nonmax, found, expected);
+          mismatches++;
+        }
+      }
+    }
+  }
+  if(!mismatches)
+    snprintf(detail, sizeof(detail), "%s kernel, %d cases, %zu corners", FastDetector::simdKernel(), cases, corners);
+  return Report("fast corners simd == scalar", mismatches == 0, detail);
+}
+
+// Past the cap, the strongest corners are kept wherever they are in the frame
+bool CheckFastCornerCap(){
+  const int k_width = 320, k_height = 240;
+  const size_t k_caps[] = { 1, 16, 200 };
+
+  int mismatches = 0;
+  char detail[160] = "";
+  std::vector<unsigned char> img;
+  std::vector<Keypoint> all, capped, expected;
+  SyntheticImage(img, k_width, k_height, k_width, 99);
+  FastDetector reference(10, true);
+  reference.setUseSimd(false);
+  size_t found = reference.detect(&img[0], k_width, k_height, k_width, all, 1 << 20);
+  for(size_t c = 0; c < sizeof(k_caps) / sizeof(size_t); c++){
+    expected = all;
+    std::sort(expected.begin(), expected.end(), Stronger);
+    expected.resize(std::min(k_caps[c], expected.size()));
+    std::sort(expected.begin(), expected.end(), RasterOrder);
+    FastDetector detector(10, true);
+    detector.detect(&img[0], k_width, k_height, k_width, capped, k_caps[c]);
+    if(!SameKeypoints(capped, expected)){
+      if(!mismatches)
+        snprintf(detail, sizeof(detail), "cap %zu: kept %zu corners, not the strongest of %zu",
+                 k_caps[c], capped.size(), found);
+      mismatches++;
+    }
+  }
+  if(!mismatches)
+    snprintf(detail, sizeof(detail), "strongest kept of %zu corners at %d caps", found,
+             (int)(sizeof(k_caps) / sizeof(size_t)));
+  return Report("fast corner cap", mismatches == 0, detail);
+}
+
+/* ************************************************************************* */
+bool CheckFrameChangeSums(){
+  struct Size { int width, height, stride; };
+  // Odd block counts leave a block for the scalar tail; ragged widths leave pixels over
+  const Size k_sizes[] = { {640, 480, 640}, {328, 240, 352}, {37, 23, 37}, {8, 8, 8}, {24, 17, 40} };
+  const int k_frames = 6;
+
+  int cases = 0, mismatches = 0;
+  char detail[160] = "";
+  std::vector<unsigned char> img;
+  for(size_t s = 0; s < sizeof(k_sizes) / sizeof(Size); s++){
+    const Size& size = k_sizes[s];
+    FrameChangeFilter vector(2.0f, 3), reference(2.0f, 3);
+    reference.setUseSimd(false);
+    for(int f = 0; f < k_frames; f++){
+      // Repeat a frame now and then so the still and min-rate paths run too
+      SyntheticImage(img, size.width, size.height, size.stride, 101 + s * 10 + f / 2);
+      FrameChangeFilter::Decision a = vector.check(&img[0], size.width, size.height, size.stride);
+      FrameChangeFilter::Decision b = reference.check(&img[0], size.width, size.height, size.stride);
+      cases++;
+      if(vector.lastBlockSums() != reference.lastBlockSums() || a.keep != b.keep ||
+         a.change != b.change || a.reason != b.reason){
+        if(!mismatches)
+          snprintf(detail, sizeof(detail), "%dx%d stride %d frame %d: change %g (%s), expected %g (%s)",
+                   size.width, size.height, size.stride, f, a.change, FrameChangeFilter::reasonName(a.reason),
+                   b.change, FrameChangeFilter::reasonName(b.reason));
+        mismatches++;
+      }
+    }
+  }
+  if(!mismatches)
+    snprintf(detail, sizeof(detail), "%d frames", cases);
+  return Report("frame change simd == scalar", mismatches == 0, detail);
+}
+
+bool CheckFrameChangeTooSmall(){
+  const int k_frames = 3;
+  std::vector<unsigned char> img;
+  FrameChangeFilter filter;
+  int tooSmall = 0;
+  for(int f = 0; f < k_frames; f++){
+    SyntheticImage(img, 7, 20, 7, 5);
+    FrameChangeFilter::Decision decision = filter.check(&img[0], 7, 20, 7);
+    tooSmall += decision.keep && decision.reason == FrameChangeFilter::KEEP_TOO_SMALL &&
+                filter.lastBlockSums().empty();
+  }
+  // A full size frame afterwards starts over
+  SyntheticImage(img, 16, 16, 16, 5);
+  FrameChangeFilter::Decision decision = filter.check(&img[0], 16, 16, 16);
+  bool ok = tooSmall == k_frames && decision.reason == FrameChangeFilter::KEEP_FIRST;
+  char detail[80];
+  snprintf(detail, sizeof(detail), "%d of %d kept as too-small, then %s", tooSmall, k_frames,
+           FrameChangeFilter::reasonName(decision.reason));
+  return Report("frame change under one block", ok, detail);
+}
+
+/* ************************************************************************* */
+int main(){
+  int failures = 0;
+  failures += !CheckFastCorners();
+  failures += !CheckFastCornerCap();
+  failures += !CheckFrameChangeSums();
+  failures += !CheckFrameChangeTooSmall();
+  if(failures){
+    std::cout << failures << " check(s) failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * AllocCounter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Interposes the glibc allocator. Nothing in here may allocate.
+ */
+
+#include "AllocCounter.h"
+#include <stdlib.h>
+#include <errno.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+}
+
+static volatile bool s_armed = false;
+static volatile bool s_abort = false;
+static unsigned long long s_count = 0;
+static unsigned long long s_bytes = 0;
+
+static inline void record(size_t size) {
+    if(!s_armed)
+        return;
+    __sync_fetch_and_add(&s_count, 1ULL);
+    __sync_fetch_and_add(&s_bytes, (unsigned long long)size);
+    if(s_abort)
+        abort();
+}
+
+void AllocCounter::arm() {
+    s_count = 0;
+    s_bytes = 0;
+    __sync_synchronize();
+    s_armed = true;
+}
+
+void AllocCounter::disarm() {
+    s_armed = false;
+    __sync_synchronize();
+}
+
+unsigned long long AllocCounter::count() {
+    return __sync_fetch_and_add(&s_count, 0ULL);
+}
+
+unsigned long long AllocCounter::bytes() {
+    return __sync_fetch_and_add(&s_bytes, 0ULL);
+}
+
+void AllocCounter::setAbortOnAllocation(bool abortOnAllocation) {
+    s_abort = abortOnAllocation;
+}
+
+extern "C" {
+
+void *malloc(size_t size) {
+    record(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    record(n * size);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    record(size);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    record(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    record(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    record(size);
+    void *p = __libc_memalign(alignment, size);
+    if(!p)
+        return ENOMEM;
+    *ptr = p;
+    return 0;
+}
+
+}
@@ -0,0 +1,48 @@
+/*
+ * AllocCounter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ALLOCCOUNTER_H_
+#define ALLOCCOUNTER_H_
+
+/**
+ * Counts heap allocations while armed, to prove the logging pipeline runs
+ * without allocating once it has warmed up.
+ *
+ * AllocCounter.cpp replaces malloc, calloc, realloc and the aligned
+ * variants (operator new goes through malloc), so it must only be linked
+ * into diagnostic builds: the allocCheck tool, or bbLog configured with
+ * -DBBLOG_ALLOC_CHECK=ON.
+ */
+namespace AllocCounter {
+
+    /**
+     * Starts counting from zero.
+     */
+    void arm();
+
+    /**
+     * Stops counting; the count is kept.
+     */
+    void disarm();
+
+    /**
+     * Allocations seen while armed.
+     */
+    unsigned long long count();
+
+    /**
+     * Bytes requested by those allocations.
+     */
+    unsigned long long bytes();
+
+    /**
+     * Calls abort() on the first allocation while armed, so a debugger or
+     * core dump shows who allocated.
+     */
+    void setAbortOnAllocation(bool abortOnAllocation);
+}
+
+#endif /* ALLOCCOUNTER_H_ */
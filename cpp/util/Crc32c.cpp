@@ -0,0 +1,143 @@
+/*
+ * Crc32c.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Crc32c.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_X86
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARMV8
+#endif
+
+// Slicing-by-8 folds words loaded in little endian order; big endian hosts
+// take the byte at a time loop instead
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CRC32C_SLICING
+#endif
+
+// Reflected Castagnoli polynomial
+static const unsigned int kPolynomial = 0x82F63B78;
+
+static unsigned int s_table[8][256];
+
+// Filled before main() so crc32c() is safe to call from any thread
+static struct TableInit {
+    TableInit() {
+        for(unsigned int i = 0; i < 256; i++)
+        {
+            unsigned int crc = i;
+            for(int k = 0; k < 8; k++)
+                crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1)));
+            s_table[0][i] = crc;
+        }
+        for(unsigned int i = 0; i < 256; i++)
+            for(int t = 1; t < 8; t++)
+                s_table[t][i] = (s_table[t - 1][i] >> 8) ^ s_table[0][s_table[t - 1][i] & 0xff];
+    }
+} s_tableInit;
+
+unsigned int crc32cSoftware(unsigned int crc, const void *data, size_t length) {
+    const unsigned char *p = (const unsigned char *)data;
+    crc = ~crc;
+#if defined(CRC32C_SLICING)
+    for(; length > 0 && ((size_t)p & 7); length--)
+        crc = (crc >> 8) ^ s_table[0][(crc ^ *p++) & 0xff];
+    for(; length >= 8; length -= 8, p += 8)
+    {
+        // Little endian: the first four bytes fold into the running crc
+        unsigned int lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = s_table[7][lo & 0xff] ^ s_table[6][(lo >> 8) & 0xff] ^
+              s_table[5][(lo >> 16) & 0xff] ^ s_table[4][lo >> 24] ^
+              s_table[3][hi & 0xff] ^ s_table[2][(hi >> 8) & 0xff] ^
+              s_table[1][(hi >> 16) & 0xff] ^ s_table[0][hi >> 24];
+    }
+#endif
+    for(; length > 0; length--)
+        crc = (crc >> 8) ^ s_table[0][(crc ^ *p++) & 0xff];
+    return ~crc;
+}
+
+#if defined(CRC32C_X86)
+__attribute__((target("sse4.2")))
+static unsigned int crc32cHardware(unsigned int crc, const void *data, size_t length) {
+    const unsigned char *p = (const unsigned char *)data;
+    crc = ~crc;
+    for(; length > 0 && ((size_t)p & 7); length--)
+        crc = _mm_crc32_u8(crc, *p++);
+#if defined(__x86_64__)
+    unsigned long long crc64 = crc;
+    for(; length >= 8; length -= 8, p += 8)
+    {
+        unsigned long long v;
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = (unsigned int)crc64;
+#endif
+    for(; length >= 4; length -= 4, p += 4)
+    {
+        unsigned int v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+    }
+    for(; length > 0; length--)
+        crc = _mm_crc32_u8(crc, *p++);
+    return ~crc;
+}
+
+static bool hardwareAvailable() {
+    static const bool available = __builtin_cpu_supports("sse4.2");
+    return available;
+}
+#elif defined(CRC32C_ARMV8)
+static unsigned int crc32cHardware(unsigned int crc, const void *data, size_t length) {
+    const unsigned char *p = (const unsigned char *)data;
+    crc = ~crc;
+    for(; length > 0 && ((size_t)p & 7); length--)
+        crc = __crc32cb(crc, *p++);
+    for(; length >= 8; length -= 8, p += 8)
+    {
+        unsigned long long v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+    }
+    for(; length > 0; length--)
+        crc = __crc32cb(crc, *p++);
+    return ~crc;
+}
+
+static bool hardwareAvailable() {
+    return true;
+}
+#endif
+
+unsigned int crc32c(unsigned int crc, const void *data, size_t length) {
+#if defined(CRC32C_X86) || defined(CRC32C_ARMV8)
+    if(hardwareAvailable())
+        return crc32cHardware(crc, data, length);
+#endif
+    return crc32cSoftware(crc, data, length);
+}
+
+const char *crc32cKernel() {
+#if defined(CRC32C_X86)
+    if(hardwareAvailable())
+        return "sse4.2";
+#elif defined(CRC32C_ARMV8)
+    return "armv8";
+#endif
+#if defined(CRC32C_SLICING)
+    return "slicing-by-8";
+#else
+    return "bytewise";
+#endif
+}
@@ -0,0 +1,35 @@
+/*
+ * Crc32c.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CRC32C_H_
+#define CRC32C_H_
+
+#include <stddef.h>
+
+/**
+ * CRC-32C (Castagnoli), as used by iSCSI, ext4 and SSE4.2.
+ *
+ * Pass 0 as crc to start, or the result of a previous call to continue over
+ * more data: crc32c(crc32c(0, a, n), b, m) == crc32c(0, ab, n + m).
+ * Uses the SSE4.2 crc32 instruction when the CPU has it (checked at run
+ * time), the ARMv8 CRC32 instructions when compiled for them, and
+ * slicing-by-8 tables otherwise (eg. on the Cortex-A8 of the BeagleBone),
+ * or a byte at a time on big endian hosts.
+ */
+unsigned int crc32c(unsigned int crc, const void *data, size_t length);
+
+/**
+ * Name of the implementation crc32c() uses here ("sse4.2", "armv8",
+ * "slicing-by-8" or "bytewise").
+ */
+const char *crc32cKernel();
+
+/**
+ * The table driven implementation, always available for checking.
+ */
+unsigned int crc32cSoftware(unsigned int crc, const void *data, size_t length);
+
+#endif /* CRC32C_H_ */
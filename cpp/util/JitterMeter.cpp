@@ -0,0 +1,97 @@
+/*
+ * JitterMeter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "JitterMeter.h"
+#include <math.h>
+#include <string.h>
+
+JitterMeter::JitterMeter(double nominalHz)
+    : _period(1e9 / nominalHz)
+{
+    reset();
+}
+
+void JitterMeter::reset() {
+    _last = 0;
+    _started = false;
+    _intervals = 0;
+    _gaps = 0;
+    _missing = 0;
+    _sum = 0;
+    _sumSquares = 0;
+    _min = 0;
+    _max = 0;
+    memset(_histogram, 0, sizeof(_histogram));
+}
+
+double JitterMeter::add(long long stamp) {
+    if(!_started)
+    {
+        _started = true;
+        _last = stamp;
+        return 0;
+    }
+    double interval = (double)(stamp - _last);
+    _last = stamp;
+    double deviation = interval - _period;
+
+    if(interval > 1.5 * _period)
+    {
+        _gaps++;
+        _missing += (unsigned long long)(interval / _period + 0.5) - 1;
+    }
+    if(_intervals == 0 || deviation < _min)
+        _min = deviation;
+    if(_intervals == 0 || deviation > _max)
+        _max = deviation;
+    _intervals++;
+    _sum += deviation;
+    _sumSquares += deviation * deviation;
+
+    int bucket = (int)floor(deviation / _period * kBucketsPerPeriod) + kBucketsPerPeriod + 1;
+    if(bucket < 0)
+        bucket = 0;
+    if(bucket >= kNumBuckets)
+        bucket = kNumBuckets - 1;
+    _histogram[bucket]++;
+
+    return deviation * 1e-9;
+}
+
+JitterStats JitterMeter::stats() const {
+    JitterStats s;
+    s.intervals = _intervals;
+    s.gaps = _gaps;
+    s.missing = _missing;
+    s.meanDeviation = _intervals ? _sum / _intervals * 1e-9 : 0;
+    s.rmsDeviation = _intervals ? sqrt(_sumSquares / _intervals) * 1e-9 : 0;
+    s.minDeviation = _min * 1e-9;
+    s.maxDeviation = _max * 1e-9;
+    return s;
+}
+
+void JitterMeter::writeReport(std::ostream& out) const {
+    JitterStats s = stats();
+    out << "nominal period (ms): " << _period * 1e-6 << std::endl
+        << "intervals: " << s.intervals << std::endl
+        << "gaps (> 1.5 periods): " << s.gaps << ", missing samples: " << s.missing << std::endl
+        << "deviation (ms): mean " << s.meanDeviation * 1e3 << ", rms " << s.rmsDeviation * 1e3
+        << ", min " << s.minDeviation * 1e3 << ", max " << s.maxDeviation * 1e3 << std::endl
+        << "histogram (deviation from, ms / count):" << std::endl;
+    double bucketMs = _period * 1e-6 / kBucketsPerPeriod;
+    for(int i = 0; i < kNumBuckets; i++)
+    {
+        if(_histogram[i] == 0)
+            continue;
+        if(i == 0)
+            out << "  < " << -kBucketsPerPeriod * bucketMs;
+        else if(i == kNumBuckets - 1)
+            out << "  >= " << (kNumBuckets - 2 - kBucketsPerPeriod) * bucketMs;
+        else
+            out << "  " << (i - 1 - kBucketsPerPeriod) * bucketMs;
+        out << " " << _histogram[i] << std::endl;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * JitterMeter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef JITTERMETER_H_
+#define JITTERMETER_H_
+
+#include <stddef.h>
+#include <ostream>
+
+/**
+ * Summary of the intervals seen by a JitterMeter. Deviations are the
+ * interval minus the nominal period, in seconds.
+ */
+struct JitterStats {
+    unsigned long long intervals;
+    /** Intervals longer than 1.5 nominal periods. */
+    unsigned long long gaps;
+    /** Samples missing inside those gaps, assuming the nominal rate. */
+    unsigned long long missing;
+    double meanDeviation;
+    double rmsDeviation;
+    /** Most negative and most positive deviation. */
+    double minDeviation;
+    double maxDeviation;
+};
+
+/**
+ * Measures the inter-arrival deviation of a periodic stream (eg. the IMU
+ * lines) against its nominal rate. add() is O(1) and does not allocate;
+ * deviations are also kept in a fixed histogram with buckets of a tenth of
+ * a period from -1 to +4 periods.
+ */
+class JitterMeter {
+public:
+    JitterMeter(double nominalHz);
+
+    /**
+     * Records an arrival at stamp (nanoseconds, monotonic clock) and returns
+     * the deviation of the interval since the previous arrival in seconds,
+     * or 0 for the first arrival.
+     */
+    double add(long long stamp);
+
+    void reset();
+
+    JitterStats stats() const;
+
+    double nominalPeriod() const { return _period * 1e-9; }
+
+    /**
+     * Writes the summary and the non-empty histogram buckets as text.
+     */
+    void writeReport(std::ostream& out) const;
+
+private:
+    static const int kBucketsPerPeriod = 10;
+    static const int kNumBuckets = 5 * kBucketsPerPeriod + 2;
+
+    double _period;
+    long long _last;
+    bool _started;
+    unsigned long long _intervals;
+    unsigned long long _gaps;
+    unsigned long long _missing;
+    double _sum;
+    double _sumSquares;
+    double _min;
+    double _max;
+    // [0] below -1 period, [kNumBuckets - 1] above +4 periods
+    unsigned long long _histogram[kNumBuckets];
+};
+
+#endif /* JITTERMETER_H_ */
@@ -0,0 +1,89 @@
+/*
+ * RealTime.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "RealTime.h"
+#include <iostream>
+#include <alloca.h>
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+bool parseThreadPolicy(const char *spec, ThreadPolicy& policy) {
+    char *end;
+    long priority = strtol(spec, &end, 10);
+    if(end == spec || priority < 0 || priority > 99)
+        return false;
+    long cpu = -1;
+    if(*end == '@')
+    {
+        const char *cpuSpec = end + 1;
+        cpu = strtol(cpuSpec, &end, 10);
+        if(end == cpuSpec || cpu < 0 || cpu >= CPU_SETSIZE)
+            return false;
+    }
+    if(*end != '\0')
+        return false;
+    policy.priority = (int)priority;
+    policy.cpu = (int)cpu;
+    return true;
+}
+
+bool applyThreadPolicy(pthread_t thread, const ThreadPolicy& policy, const char *name) {
+    bool ok = true;
+    if(policy.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(policy.cpu, &cpus);
+        int err = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+        if(err != 0)
+        {
+            std::cerr << "Failed to pin " << name << " thread to CPU " << policy.cpu
+                      << ": " << strerror(err) << std::endl;
+            ok = false;
+        }
+    }
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = policy.priority;
+    bool fifo = policy.priority > 0;
+    int err = pthread_setschedparam(thread, fifo ? SCHED_FIFO : SCHED_OTHER, &param);
+    if(err != 0)
+    {
+        std::cerr << "Failed to set " << (fifo ? "SCHED_FIFO" : "SCHED_OTHER") << " priority "
+                  << policy.priority << " on " << name << " thread: " << strerror(err) << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+bool applyThreadPolicy(const ThreadPolicy& policy, const char *name) {
+    return applyThreadPolicy(pthread_self(), policy, name);
+}
+
+// Kept out of line so the compiler can't drop the stack touch
+static void __attribute__((noinline)) prefaultStack(size_t bytes) {
+    volatile char *stack = (volatile char *)alloca(bytes);
+    for(size_t i = 0; i < bytes; i += 4096)
+        stack[i] = 0;
+}
+
+bool lockProcessMemory(size_t stackBytes) {
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        std::cerr << "Failed to lock process memory: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if(stackBytes > 0)
+        prefaultStack(stackBytes);
+    return true;
+}
@@ -0,0 +1,53 @@
+/*
+ * RealTime.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef REALTIME_H_
+#define REALTIME_H_
+
+#include <pthread.h>
+
+/**
+ * Scheduling of one thread: a SCHED_FIFO priority and a CPU to pin to.
+ * The default leaves the thread under SCHED_OTHER on any CPU.
+ */
+struct ThreadPolicy {
+    /** SCHED_FIFO priority (1-99); 0 keeps the normal time-sharing scheduler. */
+    int priority;
+    /** CPU the thread is pinned to; -1 lets the kernel choose. */
+    int cpu;
+
+    ThreadPolicy() : priority(0), cpu(-1) {}
+    ThreadPolicy(int priority, int cpu = -1) : priority(priority), cpu(cpu) {}
+
+    bool isDefault() const { return priority == 0 && cpu < 0; }
+};
+
+/**
+ * Parses "PRIO" or "PRIO@CPU", eg. "80@0". Returns false on malformed input.
+ */
+bool parseThreadPolicy(const char *spec, ThreadPolicy& policy);
+
+/**
+ * Applies the policy to a running thread. name is only used in error
+ * messages. Setting SCHED_FIFO needs root or CAP_SYS_NICE; on failure the
+ * thread keeps its old policy, the reason is printed and false is returned.
+ */
+bool applyThreadPolicy(pthread_t thread, const ThreadPolicy& policy, const char *name);
+
+/**
+ * Applies the policy to the calling thread.
+ */
+bool applyThreadPolicy(const ThreadPolicy& policy, const char *name);
+
+/**
+ * Locks all current and future pages of the process in RAM (mlockall) and
+ * touches stackBytes of the calling thread's stack so the first deep call
+ * does not page fault. Call after the big buffers are allocated: every
+ * thread stack started later is locked as a whole.
+ */
+bool lockProcessMemory(size_t stackBytes = 64 * 1024);
+
+#endif /* REALTIME_H_ */
@@ -0,0 +1,302 @@
+/*
+ * FastCorners.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FastCorners.h"
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FAST_USE_NEON
+#endif
+
+// Bresenham circle of radius 3, clockwise from the top
+static const int kCircle[16][2] = {
+    { 0, -3}, { 1, -3}, { 2, -2}, { 3, -1}, { 3,  0}, { 3,  1}, { 2,  2}, { 1,  3},
+    { 0,  3}, {-1,  3}, {-2,  2}, {-3,  1}, {-3,  0}, {-3, -1}, {-2, -2}, {-1, -3}
+};
+
+// True if the 16 bit circular mask has 9 consecutive bits set
+static inline bool hasArc9(unsigned int mask) {
+    unsigned int x = mask | (mask << 16);
+    unsigned int a = x & (x >> 1);  // runs of 2
+    unsigned int b = a & (a >> 2);  // runs of 4
+    unsigned int c = b & (b >> 4);  // runs of 8
+    return (c & (x >> 8)) != 0;     // runs of 9
+}
+
+// Full segment test at p, returns the corner score or 0
+static inline int cornerScore(const unsigned char *p, const int *offsets, int threshold) {
+    int v = p[0];
+    int hi = v + threshold;
+    int lo = v - threshold;
+    unsigned int bright = 0, dark = 0;
+    int brightSum = 0, darkSum = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        int q = p[offsets[i]];
+        if(q > hi)
+        {
+            bright |= 1u << i;
+            brightSum += q - hi;
+        }
+        else if(q < lo)
+        {
+            dark |= 1u << i;
+            darkSum += lo - q;
+        }
+    }
+    int score = 0;
+    if(hasArc9(bright))
+        score = brightSum;
+    if(hasArc9(dark) && darkSum > score)
+        score = darkSum;
+    return score > 0xFFFF ? 0xFFFF : score;
+}
+
+FastDetector::FastDetector(int threshold, bool nonmaxSuppression)
+    : _threshold(threshold), _nonmax(nonmaxSuppression), _useSimd(true),
+      _width(0), _stride(0)
+{
+}
+
+const char *FastDetector::simdKernel() {
+#if defined(__SSE2__)
+    return "sse2";
+#elif defined(FAST_USE_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void FastDetector::prepare(int width, int stride) {
+    if(width != _width)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            _scores[i].assign(width, 0);
+            _candidates[i].clear();
+            _candidates[i].reserve(width);
+        }
+        _width = width;
+    }
+    if(stride != _stride)
+    {
+        for(int i = 0; i < 16; i++)
+            _offsets[i] = kCircle[i][0] + kCircle[i][1] * stride;
+        _stride = stride;
+    }
+}
+
+void FastDetector::scanRow(const unsigned char *row, int width, std::vector<unsigned short>& scores,
+                           std::vector<int>& candidates) {
+    int x = 3;
+    if(_useSimd)
+        x = scanRowSimd(row, width, scores, candidates);
+    for(; x < width - 3; x++)
+    {
+        int score = cornerScore(row + x, _offsets, _threshold);
+        if(score)
+        {
+            scores[x] = (unsigned short)score;
+            candidates.push_back(x);
+        }
+    }
+}
+
+#if defined(__SSE2__)
+int FastDetector::scanRowSimd(const unsigned char *row, int width, std::vector<unsigned short>& scores,
+                              std::vector<int>& candidates) {
+    const __m128i t = _mm_set1_epi8((char)(_threshold > 255 ? 255 : _threshold));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i minusOne = _mm_set1_epi8(-1);
+    const int up = _offsets[0], right = _offsets[4], down = _offsets[8], left = _offsets[12];
+    int x = 3;
+    for(; x + 16 <= width - 3; x += 16)
+    {
+        const unsigned char *p = row + x;
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i hi = _mm_adds_epu8(v, t);
+        __m128i lo = _mm_subs_epu8(v, t);
+        __m128i c[4];
+        c[0] = _mm_loadu_si128((const __m128i *)(p + up));
+        c[1] = _mm_loadu_si128((const __m128i *)(p + right));
+        c[2] = _mm_loadu_si128((const __m128i *)(p + down));
+        c[3] = _mm_loadu_si128((const __m128i *)(p + left));
+        __m128i nBright = zero, nDark = zero;
+        for(int k = 0; k < 4; k++)
+        {
+            // Lanes are -1 where the compass pixel is beyond the threshold
+            __m128i bright = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_subs_epu8(c[k], hi), zero), minusOne);
+            __m128i dark = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_subs_epu8(lo, c[k]), zero), minusOne);
+            nBright = _mm_add_epi8(nBright, bright);
+            nDark = _mm_add_epi8(nDark, dark);
+        }
+        // At least two of the four compass pixels on the same side
+        __m128i pass = _mm_or_si128(_mm_cmplt_epi8(nBright, minusOne), _mm_cmplt_epi8(nDark, minusOne));
+        int mask = _mm_movemask_epi8(pass);
+        while(mask)
+        {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            int score = cornerScore(p + i, _offsets, _threshold);
+            if(score)
+            {
+                scores[x + i] = (unsigned short)score;
+                candidates.push_back(x + i);
+            }
+        }
+    }
+    return x;
+}
+#elif defined(FAST_USE_NEON)
+int FastDetector::scanRowSimd(const unsigned char *row, int width, std::vector<unsigned short>& scores,
+                              std::vector<int>& candidates) {
+    const uint8x16_t t = vdupq_n_u8((unsigned char)(_threshold > 255 ? 255 : _threshold));
+    const uint8x16_t one = vdupq_n_u8(1);
+    const uint8x16_t two = vdupq_n_u8(2);
+    const int up = _offsets[0], right = _offsets[4], down = _offsets[8], left = _offsets[12];
+    unsigned char lanes[16];
+    int x = 3;
+    for(; x + 16 <= width - 3; x += 16)
+    {
+        const unsigned char *p = row + x;
+        uint8x16_t v = vld1q_u8(p);
+        uint8x16_t hi = vqaddq_u8(v, t);
+        uint8x16_t lo = vqsubq_u8(v, t);
+        uint8x16_t c[4];
+        c[0] = vld1q_u8(p + up);
+        c[1] = vld1q_u8(p + right);
+        c[2] = vld1q_u8(p + down);
+        c[3] = vld1q_u8(p + left);
+        uint8x16_t nBright = vdupq_n_u8(0), nDark = vdupq_n_u8(0);
+        for(int k = 0; k < 4; k++)
+        {
+            nBright = vaddq_u8(nBright, vandq_u8(vcgtq_u8(c[k], hi), one));
+            nDark = vaddq_u8(nDark, vandq_u8(vcltq_u8(c[k], lo), one));
+        }
+        uint8x16_t pass = vorrq_u8(vcgeq_u8(nBright, two), vcgeq_u8(nDark, two));
+        uint64x2_t any = vreinterpretq_u64_u8(pass);
+        if((vgetq_lane_u64(any, 0) | vgetq_lane_u64(any, 1)) == 0)
+            continue;
+        vst1q_u8(lanes, pass);
+        for(int i = 0; i < 16; i++)
+        {
+            if(!lanes[i])
+                continue;
+            int score = cornerScore(p + i, _offsets, _threshold);
+            if(score)
+            {
+                scores[x + i] = (unsigned short)score;
+                candidates.push_back(x + i);
+            }
+        }
+    }
+    return x;
+}
+#else
+int FastDetector::scanRowSimd(const unsigned char *, int, std::vector<unsigned short>&,
+                              std::vector<int>&) {
+    return 3;
+}
+#endif
+
+// Ranks keypoints by score, ties going to the first in raster order. As a
+// heap order it puts the weakest kept keypoint on top
+static bool stronger(const Keypoint& a, const Keypoint& b) {
+    if(a.score != b.score)
+        return a.score > b.score;
+    return a.y != b.y ? a.y < b.y : a.x < b.x;
+}
+
+static bool rasterOrder(const Keypoint& a, const Keypoint& b) {
+    return a.y != b.y ? a.y < b.y : a.x < b.x;
+}
+
+size_t FastDetector::detect(const unsigned char *img, int width, int height, int stride,
+                            std::vector<Keypoint>& keypoints, size_t maxKeypoints) {
+    keypoints.clear();
+    if(width < 7 || height < 7)
+        return 0;
+    prepare(width, stride);
+    for(int i = 0; i < 3; i++)
+    {
+        for(size_t j = 0; j < _candidates[i].size(); j++)
+            _scores[i][_candidates[i][j]] = 0;
+        _candidates[i].clear();
+    }
+
+    size_t found = 0;
+    // Once maxKeypoints are kept, keypoints is a heap and a stronger corner
+    // replaces the weakest, so a busy part of the frame does not crowd out the rest
+    bool heaped = false;
+    // Row y is scanned into slot y % 3; row y-1 is then final and can be suppressed
+    for(int y = 3; y <= height - 3; y++)
+    {
+        if(y < height - 3)
+        {
+            int slot = y % 3;
+            std::vector<unsigned short>& scores = _scores[slot];
+            std::vector<int>& candidates = _candidates[slot];
+            for(size_t j = 0; j < candidates.size(); j++)
+                scores[candidates[j]] = 0;
+            candidates.clear();
+            scanRow(img + (size_t)y * stride, width, scores, candidates);
+        }
+        else
+        {
+            // Past the last row, make sure slot y % 3 reads as empty below
+            int slot = y % 3;
+            for(size_t j = 0; j < _candidates[slot].size(); j++)
+                _scores[slot][_candidates[slot][j]] = 0;
+            _candidates[slot].clear();
+        }
+
+        int prev = y - 1;
+        if(prev < 3)
+            continue;
+        const std::vector<unsigned short>& above = _scores[(prev + 2) % 3];
+        const std::vector<unsigned short>& here = _scores[prev % 3];
+        const std::vector<unsigned short>& below = _scores[(prev + 1) % 3];
+        const std::vector<int>& candidates = _candidates[prev % 3];
+        for(size_t j = 0; j < candidates.size(); j++)
+        {
+            int x = candidates[j];
+            unsigned short s = here[x];
+            if(_nonmax &&
+               (s <= here[x - 1] || s <= here[x + 1] ||
+                s <= above[x - 1] || s <= above[x] || s <= above[x + 1] ||
+                s <= below[x - 1] || s <= below[x] || s <= below[x + 1]))
+                continue;
+            Keypoint k;
+            k.x = (unsigned short)x;
+            k.y = (unsigned short)prev;
+            k.score = s;
+            if(keypoints.size() < maxKeypoints)
+                keypoints.push_back(k);
+            else if(maxKeypoints > 0)
+            {
+                if(!heaped)
+                {
+                    std::make_heap(keypoints.begin(), keypoints.end(), stronger);
+                    heaped = true;
+                }
+                if(s > keypoints.front().score)
+                {
+                    std::pop_heap(keypoints.begin(), keypoints.end(), stronger);
+                    keypoints.back() = k;
+                    std::push_heap(keypoints.begin(), keypoints.end(), stronger);
+                }
+            }
+            found++;
+        }
+    }
+    if(heaped)
+        std::sort(keypoints.begin(), keypoints.end(), rasterOrder);
+    return found;
+}
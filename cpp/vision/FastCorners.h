@@ -0,0 +1,76 @@
+/*
+ * FastCorners.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FASTCORNERS_H_
+#define FASTCORNERS_H_
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * A detected corner. score is the sum of absolute differences between the
+ * centre and the arc pixels beyond the threshold, used for non-maximum suppression.
+ */
+struct Keypoint {
+    unsigned short x;
+    unsigned short y;
+    unsigned short score;
+};
+
+/**
+ * FAST-9 corner detector on 8-bit grayscale images.
+ *
+ * Candidates are pre-filtered 16 pixels at a time with SSE2 or NEON when the
+ * compiler targets them (the four compass pixels of the circle must include
+ * two brighter or two darker ones), then confirmed with the scalar segment
+ * test. The scalar reference path is always available for checking.
+ * Scratch rows are kept between calls, so detecting on frames of the same
+ * width does not allocate once the keypoint vector has enough capacity.
+ */
+class FastDetector {
+public:
+    FastDetector(int threshold = 20, bool nonmaxSuppression = true);
+
+    /**
+     * Detects corners in img and stores the maxKeypoints strongest of them
+     * (by score, ties to the first) in keypoints, in raster order.
+     * Returns the number of corners found, which may exceed maxKeypoints.
+     */
+    size_t detect(const unsigned char *img, int width, int height, int stride,
+                  std::vector<Keypoint>& keypoints, size_t maxKeypoints);
+
+    /**
+     * Forces the scalar reference implementation.
+     */
+    void setUseSimd(bool useSimd) { _useSimd = useSimd; }
+
+    /**
+     * Name of the vector kernel compiled in ("sse2", "neon" or "scalar").
+     */
+    static const char *simdKernel();
+
+    int threshold() const { return _threshold; }
+
+private:
+    int _threshold;
+    bool _nonmax;
+    bool _useSimd;
+
+    int _width;
+    int _stride;
+    int _offsets[16];
+    // Scores and candidate columns of the last three rows, for suppression
+    std::vector<unsigned short> _scores[3];
+    std::vector<int> _candidates[3];
+
+    void prepare(int width, int stride);
+    void scanRow(const unsigned char *row, int width, std::vector<unsigned short>& scores,
+                 std::vector<int>& candidates);
+    int scanRowSimd(const unsigned char *row, int width, std::vector<unsigned short>& scores,
+                    std::vector<int>& candidates);
+};
+
+#endif /* FASTCORNERS_H_ */
@@ -0,0 +1,201 @@
+/*
+ * FeatureWorker.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FeatureWorker.h"
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+
+FeatureWorker::FeatureWorker(const std::string& logDir, bool writeKeypoints, bool writeHalfImage,
+                             int threshold, size_t maxKeypoints)
+    : _logDir(logDir), _writeKeypoints(writeKeypoints), _writeHalfImage(writeHalfImage),
+      _maxKeypoints(maxKeypoints), _detector(threshold, true),
+      _nextSequence(0), _processed(0), _dropped(0), _lastKeypointCount(0), _running(true),
+      _checksums(0)
+{
+    _keypoints.reserve(maxKeypoints);
+    for(int i = 0; i < kNumSlots; i++)
+    {
+        _slots[i].state = SLOT_FREE;
+        _slots[i].width = 0;
+        _slots[i].height = 0;
+    }
+    _thread = boost::thread(boost::bind(&FeatureWorker::run, this));
+}
+
+FeatureWorker::~FeatureWorker() {
+    stop();
+}
+
+bool FeatureWorker::setThreadPolicy(const ThreadPolicy& policy) {
+    if(!_thread.joinable())
+        return false;
+    return applyThreadPolicy(_thread.native_handle(), policy, "frame worker");
+}
+
+void FeatureWorker::setChecksums(ChecksumManifest *manifest) {
+    boost::mutex::scoped_lock lock(_lock);
+    _checksums = manifest;
+}
+
+bool FeatureWorker::submit(const unsigned char *data, int width, int height, int stride, const char *name) {
+    boost::mutex::scoped_lock lock(_lock);
+    Slot *slot = 0;
+    for(int i = 0; i < kNumSlots && !slot; i++)
+        if(_slots[i].state == SLOT_FREE)
+            slot = &_slots[i];
+    if(!slot || !_running)
+    {
+        _dropped++;
+        return false;
+    }
+    slot->state = SLOT_BUSY;
+    lock.unlock();
+
+    // Only reallocates if the frame size grows
+    slot->pixels.resize((size_t)width * height);
+    for(int y = 0; y < height; y++)
+        memcpy(&slot->pixels[(size_t)y * width], data + (size_t)y * stride, width);
+    slot->width = width;
+    slot->height = height;
+    strncpy(slot->name, name, sizeof(slot->name) - 1);
+    slot->name[sizeof(slot->name) - 1] = '\0';
+
+    lock.lock();
+    slot->state = SLOT_QUEUED;
+    slot->sequence = _nextSequence++;
+    _queued.notify_one();
+    return true;
+}
+
+void FeatureWorker::stop() {
+    {
+        boost::mutex::scoped_lock lock(_lock);
+        _running = false;
+        _queued.notify_one();
+    }
+    if(_thread.joinable())
+        _thread.join();
+}
+
+unsigned long long FeatureWorker::processed() {
+    boost::mutex::scoped_lock lock(_lock);
+    return _processed;
+}
+
+unsigned long long FeatureWorker::dropped() {
+    boost::mutex::scoped_lock lock(_lock);
+    return _dropped;
+}
+
+size_t FeatureWorker::lastKeypointCount() {
+    boost::mutex::scoped_lock lock(_lock);
+    return _lastKeypointCount;
+}
+
+void FeatureWorker::run() {
+    boost::mutex::scoped_lock lock(_lock);
+    while(true)
+    {
+        // Oldest queued frame first
+        Slot *next = 0;
+        for(int i = 0; i < kNumSlots; i++)
+            if(_slots[i].state == SLOT_QUEUED && (!next || _slots[i].sequence < next->sequence))
+                next = &_slots[i];
+        if(!next)
+        {
+            if(!_running)
+                return;
+            _queued.wait(lock);
+            continue;
+        }
+        next->state = SLOT_BUSY;
+        ChecksumManifest *checksums = _checksums;
+        lock.unlock();
+        process(*next, checksums);
+        lock.lock();
+        next->state = SLOT_FREE;
+        _processed++;
+        _lastKeypointCount = _keypoints.size();
+    }
+}
+
+void FeatureWorker::process(Slot& slot, ChecksumManifest *checksums) {
+    char path[512];
+    char name[80];
+    if(_writeKeypoints)
+    {
+        _detector.detect(&slot.pixels[0], slot.width, slot.height, slot.width, _keypoints, _maxKeypoints);
+        snprintf(path, sizeof(path), "%s%s.fast", _logDir.c_str(), slot.name);
+        if(!writeKeypointFile(path, slot.width, slot.height, _keypoints))
+            std::cerr << "Failed to write " << path << std::endl;
+        else if(checksums)
+        {
+            snprintf(name, sizeof(name), "%s.fast", slot.name);
+            checksums->addFile(path, name);
+        }
+    }
+    if(_writeHalfImage)
+    {
+        int w = slot.width / 2;
+        int h = slot.height / 2;
+        _half.resize((size_t)w * h);
+        for(int y = 0; y < h; y++)
+        {
+            const unsigned char *r0 = &slot.pixels[(size_t)(2 * y) * slot.width];
+            const unsigned char *r1 = r0 + slot.width;
+            unsigned char *out = &_half[(size_t)y * w];
+            for(int x = 0; x < w; x++)
+                out[x] = (unsigned char)((r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) >> 2);
+        }
+        snprintf(path, sizeof(path), "%s%s.pgm", _logDir.c_str(), slot.name);
+        FILE *f = fopen(path, "wb");
+        if(!f)
+        {
+            std::cerr << "Failed to write " << path << std::endl;
+            return;
+        }
+        fprintf(f, "P5\n%d %d\n255\n", w, h);
+        fwrite(&_half[0], 1, _half.size(), f);
+        if(fclose(f) != 0)
+            std::cerr << "Failed to write " << path << std::endl;
+        else if(checksums)
+        {
+            snprintf(name, sizeof(name), "%s.pgm", slot.name);
+            checksums->addFile(path, name);
+        }
+    }
+}
+
+static unsigned char *putLe(unsigned char *out, unsigned int value, size_t size) {
+    for(size_t i = 0; i < size; i++)
+        *out++ = (unsigned char)(value >> (8 * i));
+    return out;
+}
+
+bool writeKeypointFile(const char *path, int width, int height,
+                       const std::vector<Keypoint>& keypoints) {
+    FILE *f = fopen(path, "wb");
+    if(!f)
+        return false;
+    // Byte by byte, so the file reads the same whatever the host byte order
+    unsigned char header[12];
+    unsigned char *out = header;
+    memcpy(out, "FST1", 4);
+    out = putLe(out + 4, (unsigned int)width, 2);
+    out = putLe(out, (unsigned int)height, 2);
+    putLe(out, (unsigned int)keypoints.size(), 4);
+    fwrite(header, 1, sizeof(header), f);
+    for(size_t i = 0; i < keypoints.size(); i++)
+    {
+        unsigned char k[6];
+        out = putLe(k, keypoints[i].x, 2);
+        out = putLe(out, keypoints[i].y, 2);
+        putLe(out, keypoints[i].score, 2);
+        fwrite(k, 1, sizeof(k), f);
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * FeatureWorker.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FEATUREWORKER_H_
+#define FEATUREWORKER_H_
+
+#include <boost/thread.hpp>
+#include "util/RealTime.h"
+#include "log/ChecksumManifest.h"
+#include <string>
+#include <vector>
+#include "FastCorners.h"
+
+/**
+ * Post-processing of captured frames on a worker thread so the capture loop
+ * only pays for a copy. Depending on the options, each frame produces
+ *   <name>.fast : FAST-9 keypoints, see writeKeypointFile()
+ *   <name>.pgm  : the frame decimated 2x2 (half resolution)
+ * A fixed number of frame slots is allocated once; frames submitted while
+ * every slot is busy are dropped and counted.
+ */
+class FeatureWorker {
+public:
+    FeatureWorker(const std::string& logDir, bool writeKeypoints, bool writeHalfImage,
+                  int threshold = 20, size_t maxKeypoints = 2000);
+    ~FeatureWorker();
+
+    /**
+     * Copies an 8-bit grayscale frame into a free slot and queues it.
+     * name is the file name without extension. Returns false if the frame was dropped.
+     */
+    bool submit(const unsigned char *data, int width, int height, int stride, const char *name);
+
+    /**
+     * Finishes the queued frames and stops the worker thread.
+     */
+    void stop();
+
+    /**
+     * Scheduling for the worker thread.
+     */
+    bool setThreadPolicy(const ThreadPolicy& policy);
+
+    /**
+     * Records the files written from now on in manifest.
+     */
+    void setChecksums(ChecksumManifest *manifest);
+
+    unsigned long long processed();
+    unsigned long long dropped();
+
+    /**
+     * Number of keypoints found in the last processed frame.
+     */
+    size_t lastKeypointCount();
+
+private:
+    enum SlotState { SLOT_FREE, SLOT_QUEUED, SLOT_BUSY };
+    struct Slot {
+        std::vector<unsigned char> pixels;
+        int width;
+        int height;
+        char name[64];
+        SlotState state;
+        unsigned long long sequence;
+    };
+
+    static const int kNumSlots = 2;
+
+    std::string _logDir;
+    bool _writeKeypoints;
+    bool _writeHalfImage;
+    size_t _maxKeypoints;
+
+    FastDetector _detector;
+    std::vector<Keypoint> _keypoints;
+    std::vector<unsigned char> _half;
+
+    Slot _slots[kNumSlots];
+    unsigned long long _nextSequence;
+    unsigned long long _processed;
+    unsigned long long _dropped;
+    size_t _lastKeypointCount;
+    bool _running;
+    ChecksumManifest *_checksums;
+    boost::mutex _lock;
+    boost::condition_variable _queued;
+    boost::thread _thread;
+
+    void run();
+    void process(Slot& slot, ChecksumManifest *checksums);
+};
+
+/**
+ * Writes keypoints as a compact little endian binary file:
+ *   char[4] "FST1", uint16 width, uint16 height, uint32 count,
+ *   then count times uint16 x, uint16 y, uint16 score.
+ */
+bool writeKeypointFile(const char *path, int width, int height,
+                       const std::vector<Keypoint>& keypoints);
+
+#endif /* FEATUREWORKER_H_ */
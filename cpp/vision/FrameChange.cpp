@@ -0,0 +1,151 @@
+/*
+ * FrameChange.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FrameChange.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRAMECHANGE_USE_NEON
+#endif
+
+static const int kBlockSize = 8;
+// Rows 0, 2, 4 and 6 of each block are summed: 32 pixels per block
+static const int kRowStep = 2;
+static const int kPixelsPerBlock = kBlockSize * kBlockSize / kRowStep;
+
+FrameChangeFilter::FrameChangeFilter(float threshold, int keepEvery)
+    : _threshold(threshold), _keepEvery(keepEvery < 1 ? 1 : keepEvery), _useSimd(true),
+      _width(0), _height(0), _sinceKept(0), _lastKept(false), _kept(0), _skipped(0)
+{
+}
+
+const char *FrameChangeFilter::reasonName(Reason reason) {
+    switch(reason)
+    {
+    case KEEP_FIRST:    return "first";
+    case KEEP_CHANGED:  return "changed";
+    case KEEP_MIN_RATE: return "min-rate";
+    case KEEP_TOO_SMALL: return "too-small";
+    case SKIP_STILL:    return "still";
+    }
+    return "?";
+}
+
+void FrameChangeFilter::blockSums(const unsigned char *img, int blocksX, int blocksY, int stride) {
+    memset(&_current[0], 0, _current.size() * sizeof(unsigned short));
+    for(int by = 0; by < blocksY; by++)
+    {
+        unsigned short *sums = &_current[by * blocksX];
+        for(int r = 0; r < kBlockSize; r += kRowStep)
+        {
+            const unsigned char *row = img + (by * kBlockSize + r) * stride;
+            int bx = 0;
+#if defined(__SSE2__)
+            if(_useSimd)
+            {
+                // psadbw against zero sums each half of the register: two blocks
+                const __m128i zero = _mm_setzero_si128();
+                for(; bx + 2 <= blocksX; bx += 2)
+                {
+                    __m128i sad = _mm_sad_epu8(_mm_loadu_si128((const __m128i *)(row + bx * kBlockSize)), zero);
+                    sums[bx] += (unsigned short)_mm_cvtsi128_si32(sad);
+                    sums[bx + 1] += (unsigned short)_mm_extract_epi16(sad, 4);
+                }
+            }
+#elif defined(FRAMECHANGE_USE_NEON)
+            if(_useSimd)
+            {
+                for(; bx + 2 <= blocksX; bx += 2)
+                {
+                    uint64x2_t s = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vld1q_u8(row + bx * kBlockSize))));
+                    sums[bx] += (unsigned short)vgetq_lane_u64(s, 0);
+                    sums[bx + 1] += (unsigned short)vgetq_lane_u64(s, 1);
+                }
+            }
+#endif
+            for(; bx < blocksX; bx++)
+            {
+                const unsigned char *p = row + bx * kBlockSize;
+                unsigned int s = 0;
+                for(int i = 0; i < kBlockSize; i++)
+                    s += p[i];
+                sums[bx] += (unsigned short)s;
+            }
+        }
+    }
+}
+
+FrameChangeFilter::Decision FrameChangeFilter::check(const unsigned char *img, int width, int height, int stride) {
+    int blocksX = width / kBlockSize;
+    int blocksY = height / kBlockSize;
+    Decision decision;
+    decision.change = 0;
+
+    if(blocksX == 0 || blocksY == 0)
+    {
+        // Without a whole block there is no metric; keep rather than guess
+        _width = 0;
+        _height = 0;
+        _current.clear();
+        _reference.clear();
+        decision.keep = true;
+        decision.reason = KEEP_TOO_SMALL;
+    }
+    else if(width != _width || height != _height || _reference.empty())
+    {
+        _width = width;
+        _height = height;
+        _current.assign(blocksX * blocksY, 0);
+        _reference.assign(blocksX * blocksY, 0);
+        blockSums(img, blocksX, blocksY, stride);
+        decision.keep = true;
+        decision.reason = KEEP_FIRST;
+    }
+    else
+    {
+        blockSums(img, blocksX, blocksY, stride);
+        unsigned long long total = 0;
+        for(size_t i = 0; i < _current.size(); i++)
+        {
+            int d = (int)_current[i] - (int)_reference[i];
+            total += d < 0 ? -d : d;
+        }
+        decision.change = _current.empty() ? 0.0f :
+            (float)((double)total / ((double)_current.size() * kPixelsPerBlock));
+        if(decision.change >= _threshold)
+        {
+            decision.keep = true;
+            decision.reason = KEEP_CHANGED;
+        }
+        else if(_sinceKept + 1 >= _keepEvery)
+        {
+            decision.keep = true;
+            decision.reason = KEEP_MIN_RATE;
+        }
+        else
+        {
+            decision.keep = false;
+            decision.reason = SKIP_STILL;
+        }
+    }
+
+    _lastKept = decision.keep;
+    if(decision.keep)
+    {
+        _current.swap(_reference);
+        _sinceKept = 0;
+        _kept++;
+    }
+    else
+    {
+        _sinceKept++;
+        _skipped++;
+    }
+    return decision;
+}
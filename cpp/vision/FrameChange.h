@@ -0,0 +1,80 @@
+/*
+ * FrameChange.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMECHANGE_H_
+#define FRAMECHANGE_H_
+
+#include <vector>
+
+/**
+ * Decides whether a frame differs enough from the last kept one to be worth
+ * writing, so bbLog stops saving identical images on the pad and in hover.
+ *
+ * The change metric is a block-mean difference: the frame is reduced to the
+ * means of 8x8 blocks (every other row sampled, summed 16 pixels at a time
+ * with SSE2 or NEON when available) and the metric is the mean absolute
+ * difference to the block means of the last kept frame, in gray levels.
+ * Averaging over blocks keeps sensor noise well below the usual thresholds
+ * while motion and lighting changes show up. Apart from the first frame of
+ * a size, check() does not allocate.
+ */
+class FrameChangeFilter {
+public:
+    enum Reason {
+        KEEP_FIRST,       // nothing to compare with yet
+        KEEP_CHANGED,     // change at or above the threshold
+        KEEP_MIN_RATE,    // too many frames skipped in a row
+        KEEP_TOO_SMALL,   // smaller than one block, nothing to measure
+        SKIP_STILL        // change below the threshold
+    };
+
+    struct Decision {
+        bool keep;
+        float change;
+        Reason reason;
+    };
+
+    /**
+     * Frames changing less than threshold gray levels are skipped, but never
+     * more than keepEvery - 1 in a row.
+     */
+    FrameChangeFilter(float threshold = 2.0f, int keepEvery = 10);
+
+    Decision check(const unsigned char *img, int width, int height, int stride);
+
+    /**
+     * Forces the scalar implementation.
+     */
+    void setUseSimd(bool useSimd) { _useSimd = useSimd; }
+
+    /**
+     * Block sums of the frame last passed to check(), row by row, for
+     * comparing the SIMD and scalar paths. Empty for frames under a block.
+     */
+    const std::vector<unsigned short>& lastBlockSums() const { return _lastKept ? _reference : _current; }
+
+    static const char *reasonName(Reason reason);
+
+    unsigned long long kept() const { return _kept; }
+    unsigned long long skipped() const { return _skipped; }
+
+private:
+    float _threshold;
+    int _keepEvery;
+    bool _useSimd;
+    int _width;
+    int _height;
+    int _sinceKept;
+    bool _lastKept;
+    unsigned long long _kept;
+    unsigned long long _skipped;
+    std::vector<unsigned short> _current;
+    std::vector<unsigned short> _reference;
+
+    void blockSums(const unsigned char *img, int blocksX, int blocksY, int stride);
+};
+
+#endif /* FRAMECHANGE_H_ */